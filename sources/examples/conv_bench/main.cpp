@@ -0,0 +1,153 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Horizontal box blur three ways, from 512x512 up to 8K: the horizontalBoxBlur reference of the BoxFilter e2e test,
+// a per-tap stencil gather (every pixel fetched kernel_size times, as the gather kernel does) and the sliding-window
+// separable convolution (every pixel fetched once). A 2D separable box blur is timed alongside. Runs on the host.
+//
+// Usage: conv_bench [kernel_size] [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "host/bf16.hpp"
+#include "host/convolution.hpp"
+#include "host/cpu_map.hpp"
+#include "host/thread_pool.hpp"
+
+using namespace current::host;
+
+namespace {
+
+// horizontalBoxBlur from tests/current_e2e_tests.cpp on raw bf16 values; tt_metal's bfloat16(float) truncates.
+std::vector<uint16_t> horizontal_box_blur(const std::vector<uint16_t> &data, int width, int height, int kernel_size) {
+    std::vector<uint16_t> result(static_cast<size_t>(width) * height);
+    int half_k = kernel_size / 2;
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            float sum = 0.0F;
+            for (int kx = -half_k; kx <= half_k; kx++) {
+                int px = x + kx;
+                if (px >= 0 && px < width) {
+                    sum += bf16_to_float(data[static_cast<size_t>(y) * width + px]);
+                }
+            }
+            result[static_cast<size_t>(y) * width + x] =
+                float_to_bf16(sum / static_cast<float>(kernel_size), Rounding::Truncate);
+        }
+    }
+    return result;
+}
+
+double best_seconds(int repeats, const std::function<void()> &fn) {
+    double best = 1e30;
+    for (int r = 0; r < repeats; r++) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+    }
+    return best;
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    int kernel_size = argc > 1 ? std::stoi(argv[1]) : 3;
+    int repeats = argc > 2 ? std::stoi(argv[2]) : 3;
+    if (kernel_size < 1 || kernel_size % 2 == 0) {
+        std::cerr << "kernel_size must be odd and positive\n";
+        return EXIT_FAILURE;
+    }
+    auto radius = static_cast<uint32_t>(kernel_size / 2);
+
+    // Stencil gather kernel: out0 = (in0 + ... + in{k-1}) / k.
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    std::string sum = "in0";
+    for (int j = 1; j < kernel_size; j++) {
+        sum += " + in" + std::to_string(j);
+    }
+    kernel_a.set_compute_kernel("out0 = (" + sum + ") / " + std::to_string(kernel_size) + ";");
+
+    std::cout << "kernel_size " << kernel_size << ", " << ThreadPool::global().size() << " threads, best of "
+              << repeats << "\n";
+    std::cout << std::left << std::setw(12) << "image" << std::setw(20) << "method" << std::right << std::setw(12)
+              << "ms" << std::setw(12) << "Mpix/s" << std::setw(10) << "speedup" << std::setw(12) << "max diff"
+              << "\n";
+
+    const std::vector<std::pair<uint32_t, uint32_t>> sizes = {
+        {512, 512}, {1024, 1024}, {2048, 2048}, {3840, 2160}, {7680, 4320}};
+    for (auto [width, height] : sizes) {
+        size_t pixels = size_t{width} * height;
+        std::vector<uint16_t> image(pixels);
+        for (size_t i = 0; i < pixels; i++) {
+            // Smooth gradient plus a little hash noise, in [0, 1) like the e2e test's normalized image.
+            float value = static_cast<float>((i % width) + (i / width)) / static_cast<float>(width + height);
+            value += static_cast<float>(static_cast<uint32_t>(i * 2654435761U) >> 24) / 4096.0F;
+            image[i] = float_to_bf16(value);
+        }
+        std::vector<uint32_t> packed((pixels + 1) / 2, 0);
+        for (size_t i = 0; i < pixels; i++) {
+            packed[i / 2] |= static_cast<uint32_t>(image[i]) << (16 * (i & 1));
+        }
+
+        std::vector<uint16_t> reference;
+        double baseline = best_seconds(repeats, [&] {
+            reference = horizontal_box_blur(image, static_cast<int>(width), static_cast<int>(height), kernel_size);
+        });
+
+        StencilStream stencil(packed, width, height, StencilStream::row(radius), Boundary::Zero);
+        Stream sink(std::vector<uint32_t>((pixels + 1) / 2, 0), static_cast<uint32_t>(pixels));
+        CpuMap map({&kernel_a}, {&stencil, &sink});
+        map.add_connection(&stencil, &kernel_a, "in0");
+        map.add_connection(&kernel_a, "out0", &sink);
+        map.execute();  // Compile and widen the image outside the timed runs.
+        double gathered = best_seconds(repeats, [&] { map.execute(); });
+        auto gather_out = map.read_stream(&sink);
+
+        std::vector<uint32_t> sliding_out;
+        double sliding = best_seconds(repeats, [&] {
+            sliding_out = convolve_separable(packed, width, height, SeparableFilter::box(radius));
+        });
+        double sliding_2d = best_seconds(repeats, [&] {
+            convolve_separable(packed, width, height, SeparableFilter::box(radius, radius));
+        });
+
+        auto max_diff = [&](const std::vector<uint32_t> &out) {
+            float diff = 0.0F;
+            for (size_t i = 0; i < pixels; i++) {
+                diff = std::max(
+                    diff, std::abs(bf16_to_float(packed_bf16_at(out.data(), i)) - bf16_to_float(reference[i])));
+            }
+            return diff;
+        };
+        std::string name = std::to_string(width) + "x" + std::to_string(height);
+        auto row = [&](const char *method, double seconds, const std::string &diff) {
+            std::cout << std::left << std::setw(12) << name << std::setw(20) << method << std::right << std::fixed
+                      << std::setprecision(2) << std::setw(12) << seconds * 1e3 << std::setw(12)
+                      << pixels / seconds / 1e6 << std::setw(10) << baseline / seconds << std::setw(12) << diff
+                      << "\n";
+        };
+        auto format = [](float value) {
+            std::ostringstream out;
+            out << std::setprecision(4) << value;
+            return out.str();
+        };
+        row("horizontalBoxBlur", baseline, "-");
+        row("stencil gather", gathered, format(max_diff(gather_out)));
+        row("sliding window", sliding, format(max_diff(sliding_out)));
+        row("sliding window 2D", sliding_2d, "-");
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,130 @@
+#include "dataflow_api.h"
+
+#include "../../../host_lib/device/trace.hpp"
+
+// DRAM reads must be 32-byte aligned, so a packed table is read a 32-byte chunk at a time.
+constexpr uint32_t CHUNK_BYTES = 32;
+// Interleaved page size of a DRAM table (DramGeometry::page_size on the host). A multiple of CHUNK_BYTES, so no chunk
+// straddles two banks.
+constexpr uint32_t TABLE_PAGE_BYTES = 2048;
+constexpr uint32_t TILE_READS = 1024;
+
+// Where the table lives, as set up in main.cpp.
+constexpr uint32_t TABLE_REPLICATED = 0;  // A full copy in this core's L1.
+constexpr uint32_t TABLE_DRAM = 1;        // Packed in interleaved DRAM pages.
+constexpr uint32_t TABLE_SHARDED = 2;     // Sliced across the L1 of the shard cores, at the same address on each.
+
+// Routed read words of a sharded gather (current::host::PackedRoute): read_offset << LOCAL_BITS | local index.
+constexpr uint32_t LOCAL_BITS = 22;
+constexpr uint32_t LOCAL_MASK = (1U << LOCAL_BITS) - 1;
+
+// Trace zone ids, named on the host in main.cpp.
+constexpr uint32_t ZONE_GATHER_TILE = 1;
+
+// Gather side of the pipeline: turns each index tile the mover pushed into c_in1 into a tile of table values in
+// c_out0. Index reads and output writes are left to the mover on the other RISC, so this loop only touches L1 (plus
+// chunk fetches for a DRAM or sharded table).
+void kernel_main() {
+    uint32_t table_addr = get_arg_val<uint32_t>(0);
+    uint32_t table_mode = get_arg_val<uint32_t>(1);
+    uint32_t num_tiles = get_arg_val<uint32_t>(2);
+    uint32_t first_tile = get_arg_val<uint32_t>(3);
+    uint32_t counts_addr = get_arg_val<uint32_t>(4);
+    uint32_t counts_page_bytes = get_arg_val<uint32_t>(5);
+    uint32_t num_shards = get_arg_val<uint32_t>(6);
+    // Args 7 + 2s and 8 + 2s: NoC x and y of shard s.
+
+    constexpr uint32_t cb_index = tt::CB::c_in1;
+    constexpr uint32_t cb_chunk = tt::CB::c_in2;
+    constexpr uint32_t cb_counts = tt::CB::c_in3;
+    constexpr uint32_t cb_out = tt::CB::c_out0;
+
+    const InterleavedAddrGen<true> table_addr_gen = {
+        .bank_base_address = table_addr,
+        .page_size = TABLE_PAGE_BYTES,
+    };
+    const InterleavedAddrGen<true> counts_addr_gen = {
+        .bank_base_address = counts_addr,
+        .page_size = counts_page_bytes,
+    };
+    uint16_t *table = (uint16_t *)table_addr;
+    uint32_t chunk_l1_addr = get_write_ptr(cb_chunk);
+    uint16_t *chunk_ptr = (uint16_t *)chunk_l1_addr;
+    uint32_t counts_l1_addr = get_write_ptr(cb_counts);
+    uint32_t *counts = (uint32_t *)counts_l1_addr;
+
+    for (uint32_t i = 0; i < num_tiles; i++) {
+        cb_wait_front(cb_index, 1);
+        cb_reserve_back(cb_out, 1);
+        TRACE_ZONE_BEGIN(ZONE_GATHER_TILE);
+        uint32_t *indices = (uint32_t *)get_read_ptr(cb_index);
+        uint16_t *out = (uint16_t *)get_write_ptr(cb_out);
+
+        // Every slot of the tile is written below, so the output page needs no fill first.
+        if (table_mode == TABLE_DRAM) {
+            // Packed table: issue the aligned chunk reads of the whole tile back to back, one landing slot per chunk
+            // (an index in the same chunk as the one before shares its slot), so the DRAM round trips overlap and
+            // the tile waits on a single barrier. Then pick each element out of its chunk in L1.
+            uint32_t slot = 0;
+            uint32_t previous = UINT32_MAX;
+            for (uint32_t j = 0; j < TILE_READS; j++) {
+                uint32_t chunk = indices[j] * sizeof(uint16_t) / CHUNK_BYTES;
+                if (chunk != previous) {
+                    uint32_t chunk_byte = chunk * CHUNK_BYTES;
+                    noc_async_read(
+                        get_noc_addr(chunk_byte / TABLE_PAGE_BYTES, table_addr_gen, chunk_byte % TABLE_PAGE_BYTES),
+                        chunk_l1_addr + slot * CHUNK_BYTES,
+                        CHUNK_BYTES);
+                    slot++;
+                    previous = chunk;
+                }
+            }
+            noc_async_read_barrier();
+            // Replays the slot assignment above.
+            slot = 0;
+            previous = UINT32_MAX;
+            for (uint32_t j = 0; j < TILE_READS; j++) {
+                uint32_t byte_offset = indices[j] * sizeof(uint16_t);
+                uint32_t chunk = byte_offset / CHUNK_BYTES;
+                if (chunk != previous) {
+                    slot++;
+                    previous = chunk;
+                }
+                out[j] = chunk_ptr[((slot - 1) * CHUNK_BYTES + byte_offset % CHUNK_BYTES) / sizeof(uint16_t)];
+            }
+        } else if (table_mode == TABLE_SHARDED) {
+            // The tile arrives routed: its reads grouped by owning shard, in shard order, counts[s] of them for shard
+            // s. Each group is one batch of back-to-back reads at that shard's core, every read landing in its own
+            // slot, and the whole tile waits on a single barrier.
+            noc_async_read(get_noc_addr(first_tile + i, counts_addr_gen), counts_l1_addr, counts_page_bytes);
+            noc_async_read_barrier();
+            uint32_t slot = 0;
+            for (uint32_t s = 0; s < num_shards; s++) {
+                uint64_t shard_noc_addr =
+                    get_noc_addr(get_arg_val<uint32_t>(7 + 2 * s), get_arg_val<uint32_t>(8 + 2 * s), table_addr);
+                for (uint32_t end = slot + counts[s]; slot < end; slot++) {
+                    uint32_t byte_offset = (indices[slot] & LOCAL_MASK) * sizeof(uint16_t);
+                    noc_async_read(
+                        shard_noc_addr + byte_offset / CHUNK_BYTES * CHUNK_BYTES,
+                        chunk_l1_addr + slot * CHUNK_BYTES,
+                        CHUNK_BYTES);
+                }
+            }
+            noc_async_read_barrier();
+            for (uint32_t p = 0; p < TILE_READS; p++) {
+                uint32_t byte_offset = (indices[p] & LOCAL_MASK) * sizeof(uint16_t);
+                out[indices[p] >> LOCAL_BITS] =
+                    chunk_ptr[(p * CHUNK_BYTES + byte_offset % CHUNK_BYTES) / sizeof(uint16_t)];
+            }
+        } else {
+            // The table is replicated into this core's L1 at the same address on every core.
+            for (uint32_t j = 0; j < TILE_READS; j++) {
+                out[j] = table[indices[j]];
+            }
+        }
+
+        TRACE_ZONE_END(ZONE_GATHER_TILE);
+        cb_pop_front(cb_index, 1);
+        cb_push_back(cb_out, 1);
+    }
+}
@@ -0,0 +1,53 @@
+#include "dataflow_api.h"
+
+#include "../../../host_lib/device/trace.hpp"
+
+// DRAM side of the pipeline, on the RISC opposite the gather kernel: streams this core's index tiles into c_in1 and
+// the gathered tiles out of c_out0. Both CBs hold two pages, so the gather of tile i (on the other RISC) runs under
+// the read of index tile i + 1 and the write of output tile i - 1:
+//
+//   step s:  issue the read of index tile s, then wait for tile s - 1 to be gathered and issue its write;
+//            once the read lands push it (the gather of tile s starts), then wait for the write and free its page.
+void kernel_main() {
+    uint32_t index_addr = get_arg_val<uint32_t>(0);
+    uint32_t out_addr = get_arg_val<uint32_t>(1);
+    uint32_t first_tile = get_arg_val<uint32_t>(2);
+    uint32_t num_tiles = get_arg_val<uint32_t>(3);
+
+    constexpr uint32_t cb_index = tt::CB::c_in1;
+    constexpr uint32_t cb_out = tt::CB::c_out0;
+
+    const InterleavedAddrGenFast<true> index_addr_gen = {
+        .bank_base_address = index_addr,
+        .page_size = 4096,
+        .data_format = DataFormat::UInt32,
+    };
+    const InterleavedAddrGenFast<true> out_addr_gen = {
+        .bank_base_address = out_addr,
+        .page_size = 2048,
+        .data_format = DataFormat::Float16_b,
+    };
+
+    for (uint32_t s = 0; s <= num_tiles; s++) {
+        bool read = s < num_tiles;
+        bool write = s > 0;
+        if (read) {
+            cb_reserve_back(cb_index, 1);
+            TRACE_NOC_READ(4096);
+            noc_async_read_tile(first_tile + s, index_addr_gen, get_write_ptr(cb_index));
+        }
+        if (write) {
+            cb_wait_front(cb_out, 1);
+            TRACE_NOC_WRITE(2048);
+            noc_async_write_tile(first_tile + s - 1, out_addr_gen, get_read_ptr(cb_out));
+        }
+        if (read) {
+            noc_async_read_barrier();
+            cb_push_back(cb_index, 1);
+        }
+        if (write) {
+            noc_async_write_barrier();
+            cb_pop_front(cb_out, 1);
+        }
+    }
+}
@@ -0,0 +1,28 @@
+#include "dataflow_api.h"
+
+// Fans a gather table out from the one core the host uploaded it to: one NoC multicast per rectangle of gather cores
+// (current::host::multicast_ranges), into the same L1 address the table occupies here. The rectangle holding this
+// core uses the loopback variant, since a plain multicast cannot include its sender.
+void kernel_main() {
+    uint32_t table_addr = get_arg_val<uint32_t>(0);
+    uint32_t table_bytes = get_arg_val<uint32_t>(1);
+    uint32_t num_ranges = get_arg_val<uint32_t>(2);
+
+    for (uint32_t r = 0; r < num_ranges; r++) {
+        // NoC x/y of the rectangle's start and end corners, its core count, and whether it holds this core.
+        uint32_t arg = 3 + r * 6;
+        uint64_t dst_noc_addr = get_noc_multicast_addr(
+            get_arg_val<uint32_t>(arg),
+            get_arg_val<uint32_t>(arg + 1),
+            get_arg_val<uint32_t>(arg + 2),
+            get_arg_val<uint32_t>(arg + 3),
+            table_addr);
+        uint32_t num_dests = get_arg_val<uint32_t>(arg + 4);
+        if (get_arg_val<uint32_t>(arg + 5)) {
+            noc_async_write_multicast_loopback_src(table_addr, dst_noc_addr, table_bytes, num_dests);
+        } else {
+            noc_async_write_multicast(table_addr, dst_noc_addr, table_bytes, num_dests);
+        }
+    }
+    noc_async_write_barrier();
+}
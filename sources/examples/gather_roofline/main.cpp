@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Which resource binds the GatherTestSRAM graph (a pass-through kernel over a random-index GatherStream): DRAM, the
+// NoC, the reader RISCs or compute? Runs the graph on the device with the table in L1 (use_sram, as the test does) and
+// in DRAM, checks each result as the matching current_test does, and times `repeats` executions. The median device
+// time is then compared by current::host::roofline() with the traffic CpuMap models for the same graph: the table
+// copied whole into every core's L1, or read a chunk per access.
+//
+// Usage: gather_roofline [num_indices] [table_elements] [cores] [repeats]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "common.hpp"
+#include "common/tt_backend_api_types.hpp"
+#include "host/bf16.hpp"
+#include "host/compare.hpp"
+#include "host/cpu_map.hpp"
+#include "host/roofline.hpp"
+#include "map.hpp"
+#include "stream.hpp"
+
+using namespace current::host;
+
+namespace {
+
+constexpr auto TYPE = tt::DataFormat::Float16_b;
+
+std::vector<uint32_t> random_bf16(size_t count, int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-10.0F, 10.0F);
+    std::vector<float> values(count);
+    std::generate(values.begin(), values.end(), [&] { return dist(rng); });
+    std::vector<uint32_t> packed((count + 1) / 2, 0);
+    pack_bf16(values.data(), count, packed.data(), 0);
+    return packed;
+}
+
+// One execution of the GatherTestSRAM graph on a fresh Map. Returns the duration execute() reports; `expected` gets
+// the values the sink should hold, read back the way the matching test reads them.
+double run_device(
+    const std::vector<uint32_t> &table,
+    uint32_t table_elements,
+    const std::vector<uint32_t> &index_vec,
+    bool use_sram,
+    uint32_t cores,
+    std::vector<float> &expected,
+    std::vector<uint32_t> &out) {
+    auto num_indices = static_cast<uint32_t>(index_vec.size());
+    current::Kernel kernel;
+    kernel.add_input_port("in0", TYPE);
+    kernel.add_output_port("out0", TYPE);
+
+    current::GatherStream gather_stream(table, TYPE, table_elements, index_vec, use_sram);
+    current::Stream sink(std::vector<uint32_t>((num_indices + 1) / 2, 0), num_indices, TYPE);
+
+    auto tiles_per_cb = 1;
+    current::Map map({&kernel}, {&gather_stream, &sink}, cores, tiles_per_cb);
+    map.add_connection(&gather_stream, &kernel, "in0");
+    map.add_connection(&kernel, "out0", &sink);
+    map.generate_device_kernels();
+    auto duration = map.execute();
+    out = map.read_stream(&sink);
+
+    // A DRAM table is read back as GatherTest does: 32-byte chunks, one element per index.
+    auto in = unpack_bf16_vec(use_sram ? table : map.read_gather_stream(&gather_stream, true));
+    expected.resize(num_indices);
+    for (size_t i = 0; i < num_indices; i++) {
+        expected[i] = in[use_sram ? index_vec[i] : index_vec[i] * 16];
+    }
+    return std::chrono::duration<double>(duration).count();
+}
+
+// Modeled device traffic of the same graph, from its CpuMap twin. An L1 table is modeled by a budget that holds it.
+Traffic device_traffic(
+    const std::vector<uint32_t> &table,
+    uint32_t table_elements,
+    const std::vector<uint32_t> &index_vec,
+    bool use_sram,
+    uint32_t cores) {
+    auto num_indices = static_cast<uint32_t>(index_vec.size());
+    Kernel kernel;
+    kernel.add_input_port("in0");
+    kernel.add_output_port("out0");
+
+    GatherStream gather_stream(table, table_elements, index_vec);
+    Stream sink({}, num_indices);
+    CpuMap map({&kernel}, {&gather_stream, &sink});
+    map.add_connection(&gather_stream, &kernel, "in0");
+    map.add_connection(&kernel, "out0", &sink);
+    map.set_parallelization(cores);
+    return map.traffic({}, use_sram ? static_cast<uint32_t>(table.size() * sizeof(uint32_t)) : 0);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    uint32_t num_indices = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1024 * 1024;
+    uint32_t table_elements = argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1024 * 256;
+    uint32_t cores = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 1;
+    int repeats = argc > 4 ? std::atoi(argv[4]) : 5;
+    if (table_elements == 0 || repeats < 1) {
+        std::cerr << "table_elements and repeats must be at least 1\n";
+        return 1;
+    }
+
+    auto table = random_bf16(table_elements, 1);
+    std::mt19937 rng(2);
+    std::uniform_int_distribution<uint32_t> dist(0, table_elements - 1);
+    std::vector<uint32_t> index_vec(num_indices);
+    std::generate(index_vec.begin(), index_vec.end(), [&] { return dist(rng); });
+
+    bool all_passed = true;
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << num_indices << " indices into " << table_elements << " elements on " << cores << " core(s)\n";
+    for (bool use_sram : {true, false}) {
+        std::vector<float> expected;
+        std::vector<uint32_t> out;
+        std::vector<double> seconds;
+        for (int r = 0; r < repeats; r++) {
+            seconds.push_back(run_device(table, table_elements, index_vec, use_sram, cores, expected, out));
+            if (r == 0) {
+                auto result = compare_bf16(expected, out, num_indices);
+                if (!result.passed()) {
+                    std::cerr << (use_sram ? "L1" : "DRAM") << " gather failed validation:\n" << result.summary();
+                    all_passed = false;
+                }
+            }
+        }
+        std::sort(seconds.begin(), seconds.end());
+        auto report = roofline(
+            device_traffic(table, table_elements, index_vec, use_sram, cores), seconds[seconds.size() / 2]);
+        std::cout << "\nTable in " << (use_sram ? "L1" : "DRAM") << ":\n" << report.describe();
+    }
+    return all_passed ? 0 : 1;
+}
@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+
+#include "cycles.h"
+#include "dataflow_api.h"
+
+#if defined(BENCH_NOC_READ) || defined(BENCH_NOC_WRITE) || defined(BENCH_CB_PUSH_POP)
+#define BENCH_DATA_MOVEMENT
+#else
+#include "snippets.h"
+#endif
+
+// Data movement side of the microbench harness: runs the selected snippet on BRISC or NCRISC (slot 0 or 1). NoC and
+// CB snippets live here; everything else comes from snippets.h.
+void kernel_main() {
+    uint32_t iterations = get_arg_val<uint32_t>(0);
+    uint32_t results_addr = get_arg_val<uint32_t>(1);
+    uint32_t l1_addr = get_arg_val<uint32_t>(2);
+    uint32_t l1_mask = get_arg_val<uint32_t>(3);
+    uint32_t dram_addr = get_arg_val<uint32_t>(4);
+    uint32_t dram_noc_x = get_arg_val<uint32_t>(5);
+    uint32_t dram_noc_y = get_arg_val<uint32_t>(6);
+    uint32_t slot = get_arg_val<uint32_t>(7);
+    // Each RISC has its own slice of the scratch, large enough for the biggest NoC transfer.
+    uint32_t scratch = l1_addr + slot * (l1_mask + 1) * sizeof(uint32_t);
+
+#ifdef BENCH_DATA_MOVEMENT
+    uint64_t dram_noc_addr = get_noc_addr(dram_noc_x, dram_noc_y, dram_addr);
+    constexpr uint32_t cb = tt::CB::c_in0;
+    uint64_t start = read_cycles();
+    for (uint32_t i = 0; i < iterations; i++) {
+#if defined(BENCH_NOC_READ)
+        noc_async_read(dram_noc_addr, scratch, BENCH_BYTES);
+        noc_async_read_barrier();
+#elif defined(BENCH_NOC_WRITE)
+        noc_async_write(scratch, dram_noc_addr, BENCH_BYTES);
+        noc_async_write_barrier();
+#elif defined(BENCH_CB_PUSH_POP)
+        // Producer and consumer on one RISC: the bookkeeping cost of a page handoff, with no waiting.
+        cb_reserve_back(cb, 1);
+        cb_push_back(cb, 1);
+        cb_wait_front(cb, 1);
+        cb_pop_front(cb, 1);
+#endif
+    }
+    uint64_t cycles = read_cycles() - start;
+#else
+    uint64_t cycles = run_common_snippet(iterations, scratch, l1_mask);
+#endif
+    store_cycles(results_addr, slot, cycles);
+}
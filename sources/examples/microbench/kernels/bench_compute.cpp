@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <stdint.h>
+
+#include "compute_kernel_api/common.h"
+#include "snippets.h"
+
+// Compute side of the microbench harness: the same snippet runs on all three TRISCs at once, each timing its own loop
+// into slot 2 + its TRISC index and using its own slice of the L1 scratch.
+namespace NAMESPACE {
+void MAIN {
+    uint32_t iterations = get_arg_val<uint32_t>(0);
+    uint32_t results_addr = get_arg_val<uint32_t>(1);
+    uint32_t l1_addr = get_arg_val<uint32_t>(2);
+    uint32_t l1_mask = get_arg_val<uint32_t>(3);
+
+    uint32_t slot = 2 + COMPILE_FOR_TRISC;
+    uint32_t scratch = l1_addr + slot * (l1_mask + 1) * sizeof(uint32_t);
+    store_cycles(results_addr, slot, run_common_snippet(iterations, scratch, l1_mask));
+}
+}  // namespace NAMESPACE
@@ -0,0 +1,23 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include "risc_common.h"
+
+// Wall-clock cycles. Reading the low word latches the high one.
+inline uint64_t read_cycles() {
+    uint32_t lo = reg_read(RISCV_DEBUG_REG_WALL_CLOCK_L);
+    uint32_t hi = reg_read(RISCV_DEBUG_REG_WALL_CLOCK_H);
+    return (uint64_t(hi) << 32) | lo;
+}
+
+// Result slot `slot` (BRISC, NCRISC, TRISC0..2) holds the loop's cycles as a (low, high) word pair.
+inline void store_cycles(uint32_t results_addr, uint32_t slot, uint64_t cycles) {
+    volatile uint32_t *results = reinterpret_cast<volatile uint32_t *>(results_addr) + 2 * slot;
+    results[0] = uint32_t(cycles);
+    results[1] = uint32_t(cycles >> 32);
+}
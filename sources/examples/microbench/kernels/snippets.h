@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <stdint.h>
+
+#include "cycles.h"
+
+// Snippets every RISC can run, selected by the BENCH_<NAME> define from current::host::microbenchmark_registry().
+// Each is one op per loop iteration; BENCH_EMPTY is the bare loop whose cycles the host subtracts.
+
+volatile uint32_t bench_sink;  // Keeps loop results alive.
+
+// l1_mask + 1 words of scratch at l1_addr, a power of two.
+inline uint64_t run_common_snippet(uint32_t iterations, uint32_t l1_addr, uint32_t l1_mask) {
+    [[maybe_unused]] volatile uint32_t *l1 = reinterpret_cast<volatile uint32_t *>(l1_addr);
+    uint32_t count = 0;
+    uint32_t x = 0x9E3779B9;
+    uint64_t start = read_cycles();
+    for (uint32_t i = 0; i < iterations; i++) {
+#if defined(BENCH_EMPTY)
+        asm volatile("" ::: "memory");
+#elif defined(BENCH_BRANCH_PREDICTABLE)
+        // Taken 255 times in 256. The empty asm stops the compiler turning the branch into arithmetic.
+        if ((i & 0xFF) != 0xFF) {
+            asm volatile("");
+            count += 1;
+        }
+#elif defined(BENCH_XORSHIFT)
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        count += x;
+#elif defined(BENCH_BRANCH_UNPREDICTABLE)
+        // rand() is not available on the RISCs; an xorshift bit is as unpredictable for the branch predictor.
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        if (x & 1) {
+            asm volatile("");
+            count += 1;
+        }
+#elif defined(BENCH_L1_LOAD)
+        count += l1[i & l1_mask];
+#elif defined(BENCH_L1_STORE)
+        l1[i & l1_mask] = i;
+#else
+#error "snippets.h: no BENCH_ snippet selected"
+#endif
+    }
+    uint64_t cycles = read_cycles() - start;
+    bench_sink = count + x;
+    return cycles;
+}
@@ -0,0 +1,157 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// Device-cycle microbenchmarks: times each snippet of current::host::microbenchmark_registry() on every RISC of core
+// (0, 0) with the on-core wall clock, so dispatch and launch overhead never enter the numbers. The empty loop is run
+// first on each RISC and its cycles are subtracted, leaving cycles per op. NoC and CB snippets only run on the data
+// movement RISCs (BRISC, NCRISC); the rest also run on the three TRISCs, all at once.
+//
+// Usage: microbench [iterations] [benchmark...]
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "host/microbench.hpp"
+#include "host_api.hpp"
+#include "impl/buffers/buffer.hpp"
+#include "impl/device/device.hpp"
+#include "tt_metal/detail/tt_metal.hpp"
+
+using namespace tt;
+using namespace tt::tt_metal;
+using current::host::MicroBenchmark;
+
+namespace {
+
+constexpr CoreCoord core = {0, 0};
+// Words of L1 scratch per RISC: room for the largest NoC transfer, and a power of two so snippets can mask indices.
+constexpr uint32_t SCRATCH_WORDS = 2048;
+
+enum class Target { BRISC, NCRISC, TRISC };
+
+struct Buffers {
+    std::shared_ptr<Buffer> results;
+    std::shared_ptr<Buffer> scratch;
+    std::shared_ptr<Buffer> dram;
+};
+
+// Runs `benchmark` on `target` and returns the cycles of every result slot (zero for RISCs that did not run).
+std::vector<uint64_t> run(
+    Device *device, const Buffers &buffers, const MicroBenchmark &benchmark, Target target, uint32_t iterations) {
+    Program program = CreateProgram();
+    auto defines = current::host::microbenchmark_defines(benchmark);
+
+    // One page for the CB snippet.
+    CircularBufferConfig cb_config =
+        CircularBufferConfig(32, {{CB::c_in0, tt::DataFormat::Float16_b}}).set_page_size(CB::c_in0, 32);
+    CreateCircularBuffer(program, core, cb_config);
+
+    KernelHandle kernel;
+    if (target == Target::TRISC) {
+        kernel = CreateKernel(
+            program, "sources/examples/microbench/kernels/bench_compute.cpp", core, ComputeConfig{.defines = defines});
+    } else {
+        bool brisc = target == Target::BRISC;
+        kernel = CreateKernel(
+            program,
+            "sources/examples/microbench/kernels/bench.cpp",
+            core,
+            DataMovementConfig{
+                .processor = brisc ? DataMovementProcessor::RISCV_0 : DataMovementProcessor::RISCV_1,
+                .noc = brisc ? NOC::RISCV_0_default : NOC::RISCV_1_default,
+                .defines = defines});
+    }
+    auto dram_noc = buffers.dram->noc_coordinates();
+    SetRuntimeArgs(
+        program,
+        kernel,
+        core,
+        {iterations,
+         buffers.results->address(),
+         buffers.scratch->address(),
+         SCRATCH_WORDS - 1,
+         buffers.dram->address(),
+         static_cast<uint32_t>(dram_noc.x),
+         static_cast<uint32_t>(dram_noc.y),
+         target == Target::BRISC ? 0U : 1U});
+
+    std::vector<uint32_t> zeros(2 * current::host::MICROBENCH_NUM_RISCS, 0);
+    detail::WriteToDeviceL1(device, core, buffers.results->address(), zeros);
+    EnqueueProgram(device->command_queue(), program, false);
+    Finish(device->command_queue());
+    std::vector<uint32_t> words;
+    detail::ReadFromDeviceL1(device, core, buffers.results->address(), zeros.size() * sizeof(uint32_t), words);
+    return current::host::decode_cycles(words);
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    uint32_t iterations = argc > 1 ? std::stoul(argv[1]) : 100000;
+    std::set<std::string> selected(argv + std::min(argc, 2), argv + argc);
+
+    Device *device = CreateDevice(0);
+    auto l1_buffer = [&](uint32_t bytes) {
+        return CreateBuffer(InterleavedBufferConfig{
+            .device = device, .size = bytes, .page_size = bytes, .buffer_type = BufferType::L1});
+    };
+    Buffers buffers;
+    buffers.results = l1_buffer(64);
+    buffers.scratch = l1_buffer(current::host::MICROBENCH_NUM_RISCS * SCRATCH_WORDS * sizeof(uint32_t));
+    buffers.dram = CreateBuffer(InterleavedBufferConfig{
+        .device = device,
+        .size = SCRATCH_WORDS * sizeof(uint32_t),
+        .page_size = SCRATCH_WORDS * sizeof(uint32_t),
+        .buffer_type = BufferType::DRAM});
+
+    auto registry = current::host::microbenchmark_registry();
+    const auto &empty = registry.front();
+    // Baseline cycles per slot: BRISC and NCRISC from their own runs, the TRISCs from one run.
+    std::vector<uint64_t> baseline(current::host::MICROBENCH_NUM_RISCS, 0);
+    baseline[0] = run(device, buffers, empty, Target::BRISC, iterations)[0];
+    baseline[1] = run(device, buffers, empty, Target::NCRISC, iterations)[1];
+    auto trisc_baseline = run(device, buffers, empty, Target::TRISC, iterations);
+    std::copy(trisc_baseline.begin() + 2, trisc_baseline.end(), baseline.begin() + 2);
+
+    std::cout << iterations << " iterations, cycles per op over the empty loop (";
+    for (uint32_t risc = 0; risc < current::host::MICROBENCH_NUM_RISCS; risc++) {
+        std::cout << (risc > 0 ? ", " : "") << current::host::MICROBENCH_RISCS[risc] << " "
+                  << static_cast<double>(baseline[risc]) / iterations;
+    }
+    std::cout << " cycles/iteration)\n";
+    std::cout << std::setw(22) << std::left << "benchmark" << std::right;
+    for (const char *risc : current::host::MICROBENCH_RISCS) {
+        std::cout << std::setw(10) << risc;
+    }
+    std::cout << "\n" << std::fixed << std::setprecision(2);
+
+    for (const auto &benchmark : registry) {
+        if (&benchmark == &empty || (!selected.empty() && !selected.contains(benchmark.name))) {
+            continue;
+        }
+        std::vector<uint64_t> cycles(current::host::MICROBENCH_NUM_RISCS, 0);
+        cycles[0] = run(device, buffers, benchmark, Target::BRISC, iterations)[0];
+        cycles[1] = run(device, buffers, benchmark, Target::NCRISC, iterations)[1];
+        if (!benchmark.data_movement) {
+            auto trisc = run(device, buffers, benchmark, Target::TRISC, iterations);
+            std::copy(trisc.begin() + 2, trisc.end(), cycles.begin() + 2);
+        }
+        std::cout << std::setw(22) << std::left << benchmark.name << std::right;
+        for (uint32_t risc = 0; risc < current::host::MICROBENCH_NUM_RISCS; risc++) {
+            if (risc >= 2 && benchmark.data_movement) {
+                std::cout << std::setw(10) << "-";
+            } else {
+                std::cout << std::setw(10) << current::host::cycles_per_op(cycles[risc], baseline[risc], iterations);
+            }
+        }
+        std::cout << "\n";
+    }
+
+    CloseDevice(device);
+}
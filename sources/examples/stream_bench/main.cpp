@@ -0,0 +1,266 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+// STREAM bandwidth (COPY, SCALE, ADD, TRIAD, plus the B16EltwiseSAXPY pattern) over bf16 streams on the device,
+// swept across sizes, core counts and tiles_per_cb. Every configuration is validated once, run `warmup` times untimed,
+// then timed `repeats` times; min/median/max time and bandwidth are printed and written as JSON. Bytes are counted the
+// STREAM way (every array read or written once per run) and bandwidth is over the duration current::Map::execute()
+// returns, so it is device DRAM bandwidth.
+//
+// Usage: stream_bench [--sizes 1000000,10000000] [--cores 1,8] [--tiles-per-cb 1,4] [--warmup 2] [--repeats 10]
+//                     [--json stream_bench.json]
+// --cores is the Map's max_parallelization_factor. Sizes are rounded up to whole tiles.
+//
+// The "bound" column is the resource current::host::roofline() finds binding for the median device time. The traffic
+// comes from the same graph built on CpuMap, whose model depends only on the graph and its core split; the DRAM bank
+// utilization (achieved over peak bandwidth of the busiest bank) is beside it in the JSON.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "common.hpp"
+#include "common/tt_backend_api_types.hpp"
+#include "host/bf16.hpp"
+#include "host/compare.hpp"
+#include "host/cpu_map.hpp"
+#include "host/roofline.hpp"
+#include "map.hpp"
+#include "stream.hpp"
+
+using namespace current::host;
+
+namespace {
+
+constexpr float SCALAR = 3.0F;
+constexpr auto TYPE = tt::DataFormat::Float16_b;
+
+float round_bf16(float value) { return bf16_to_float(float_to_bf16(value)); }
+
+struct Benchmark {
+    const char *name;
+    const char *code;  // Over in0 = b, in1 = c.
+    size_t num_inputs;
+    float (*reference)(float b, float c);
+};
+
+// a = b, a = q * b, a = b + c, a = b + q * c, y = 2 * x + y. Each op is rounded to bf16, as on the device.
+const Benchmark BENCHMARKS[] = {
+    {"COPY", "out0 = in0;", 1, [](float b, float) { return b; }},
+    {"SCALE", "out0 = in0 * 3.0;", 1, [](float b, float) { return round_bf16(b * SCALAR); }},
+    {"ADD", "out0 = in0 + in1;", 2, [](float b, float c) { return round_bf16(b + c); }},
+    {"TRIAD", "out0 = in0 + in1 * 3.0;", 2, [](float b, float c) { return round_bf16(b + round_bf16(c * SCALAR)); }},
+    {"SAXPY", "out0 = in0 * 2.0 + in1;", 2, [](float b, float c) { return round_bf16(round_bf16(b * 2.0F) + c); }},
+};
+
+struct Summary {
+    double min = 0.0;
+    double median = 0.0;
+    double max = 0.0;
+};
+
+Summary summarize(std::vector<double> values) {
+    std::sort(values.begin(), values.end());
+    size_t n = values.size();
+    double median = n % 2 != 0 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2.0;
+    return {values.front(), median, values.back()};
+}
+
+std::vector<uint32_t> parse_list(const std::string &text) {
+    std::vector<uint32_t> values;
+    std::istringstream in(text);
+    for (std::string item; std::getline(in, item, ',');) {
+        values.push_back(std::stoul(item));
+    }
+    return values;
+}
+
+std::vector<uint32_t> random_bf16(size_t count, int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-10.0F, 10.0F);
+    std::vector<float> values(count);
+    std::generate(values.begin(), values.end(), [&] { return dist(rng); });
+    std::vector<uint32_t> packed((count + 1) / 2, 0);
+    pack_bf16(values.data(), count, packed.data(), 0);
+    return packed;
+}
+
+// One execution of `benchmark` on a fresh Map, as current_e2e_tests builds them. Returns the duration execute()
+// reports; the sink's contents land in `out`.
+double run_device(
+    const Benchmark &benchmark,
+    const std::vector<uint32_t> &b,
+    const std::vector<uint32_t> &c,
+    uint32_t count,
+    uint32_t cores,
+    uint32_t tiles_per_cb,
+    std::vector<uint32_t> &out) {
+    current::Kernel kernel;
+    kernel.add_input_port("in0", TYPE);
+    if (benchmark.num_inputs > 1) {
+        kernel.add_input_port("in1", TYPE);
+    }
+    kernel.add_output_port("out0", TYPE);
+    kernel.set_compute_kernel(benchmark.code, false);
+
+    current::Stream source0(b, count, TYPE);
+    current::Stream source1(c, count, TYPE);
+    current::Stream sink(std::vector<uint32_t>(count / 2, 0), count, TYPE);
+    std::vector<current::Stream *> streams = {&source0, &sink};
+    if (benchmark.num_inputs > 1) {
+        streams.insert(streams.begin() + 1, &source1);
+    }
+
+    current::Map map({&kernel}, streams, cores, tiles_per_cb);
+    map.add_connection(&source0, &kernel, "in0");
+    if (benchmark.num_inputs > 1) {
+        map.add_connection(&source1, &kernel, "in1");
+    }
+    map.add_connection(&kernel, "out0", &sink);
+    auto duration = map.execute();
+    out = map.read_stream(&sink);
+    return std::chrono::duration<double>(duration).count();
+}
+
+// Modeled device traffic of the graph run_device() builds, from its CpuMap twin. Only stream sizes matter to the model,
+// so the twin's streams hold no data.
+Traffic device_traffic(const Benchmark &benchmark, uint32_t count, uint32_t cores) {
+    Kernel kernel;
+    kernel.add_input_port("in0");
+    if (benchmark.num_inputs > 1) {
+        kernel.add_input_port("in1");
+    }
+    kernel.add_output_port("out0");
+    kernel.set_compute_kernel(benchmark.code);
+
+    Stream source0({}, count);
+    Stream source1({}, count);
+    Stream sink({}, count);
+    std::vector<Stream *> streams = {&source0, &sink};
+    if (benchmark.num_inputs > 1) {
+        streams.insert(streams.begin() + 1, &source1);
+    }
+
+    CpuMap map({&kernel}, streams);
+    map.add_connection(&source0, &kernel, "in0");
+    if (benchmark.num_inputs > 1) {
+        map.add_connection(&source1, &kernel, "in1");
+    }
+    map.add_connection(&kernel, "out0", &sink);
+    map.set_parallelization(cores);
+    return map.traffic();
+}
+
+}  // namespace
+
+int main(int argc, char **argv) {
+    std::vector<uint32_t> sizes = {1000000, 10000000};
+    std::vector<uint32_t> core_counts = {1, 8};
+    std::vector<uint32_t> tiles_per_cb = {1, 4};
+    int warmup = 2;
+    int repeats = 10;
+    std::string json_path = "stream_bench.json";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        std::string flag = argv[i];
+        std::string value = argv[i + 1];
+        if (flag == "--sizes") {
+            sizes = parse_list(value);
+        } else if (flag == "--cores") {
+            core_counts = parse_list(value);
+        } else if (flag == "--tiles-per-cb") {
+            tiles_per_cb = parse_list(value);
+        } else if (flag == "--warmup") {
+            warmup = std::stoi(value);
+        } else if (flag == "--repeats") {
+            repeats = std::stoi(value);
+        } else if (flag == "--json") {
+            json_path = value;
+        } else {
+            std::cerr << "Unknown flag " << flag << "\n";
+            return 1;
+        }
+    }
+    if (repeats < 1) {
+        std::cerr << "--repeats must be at least 1\n";
+        return 1;
+    }
+
+    std::ofstream json(json_path);
+    json << "{\"backend\":\"device\",\"warmup\":" << warmup << ",\"repeats\":" << repeats << ",\"results\":[";
+    bool first_result = true;
+    bool all_passed = true;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << std::setw(6) << "kernel" << std::setw(11) << "size" << std::setw(6) << "cores" << std::setw(7)
+              << "tpcb" << std::setw(10) << "MB" << std::setw(11) << "min ms" << std::setw(11) << "median ms"
+              << std::setw(11) << "max ms" << std::setw(10) << "max GB/s" << std::setw(10) << "med GB/s"
+              << std::setw(10) << "min GB/s" << "  bound\n";
+
+    for (uint32_t requested : sizes) {
+        uint32_t size = (requested + TILE_SIZE - 1) / TILE_SIZE * TILE_SIZE;
+        auto b = random_bf16(size, 1);
+        auto c = random_bf16(size, 2);
+        auto b_values = unpack_bf16_vec(b);
+        auto c_values = unpack_bf16_vec(c);
+        for (const auto &benchmark : BENCHMARKS) {
+            std::vector<float> expected(size);
+            for (size_t i = 0; i < size; i++) {
+                expected[i] = benchmark.reference(b_values[i], c_values[i]);
+            }
+            // Every input read once and the output written once, 2 bytes a value.
+            uint64_t bytes = uint64_t{size} * 2 * (benchmark.num_inputs + 1);
+            for (uint32_t cores : core_counts) {
+                for (uint32_t tiles : tiles_per_cb) {
+                    // The first run is checked; warmup runs settle program caches and DRAM state.
+                    std::vector<uint32_t> out;
+                    run_device(benchmark, b, c, size, cores, tiles, out);
+                    auto result = compare_bf16(expected, out, size);
+                    if (!result.passed()) {
+                        std::cerr << benchmark.name << " failed validation:\n" << result.summary();
+                        all_passed = false;
+                    }
+                    for (int w = 0; w < warmup; w++) {
+                        run_device(benchmark, b, c, size, cores, tiles, out);
+                    }
+                    std::vector<double> seconds;
+                    std::vector<double> bandwidth;
+                    for (int r = 0; r < repeats; r++) {
+                        double s = run_device(benchmark, b, c, size, cores, tiles, out);
+                        seconds.push_back(s);
+                        bandwidth.push_back(static_cast<double>(bytes) / s / 1e9);
+                    }
+                    auto time = summarize(seconds);
+                    auto gbps = summarize(bandwidth);
+                    auto report = roofline(device_traffic(benchmark, size, cores), time.median);
+
+                    std::cout << std::setw(6) << benchmark.name << std::setw(11) << size << std::setw(6) << cores
+                              << std::setw(7) << tiles << std::setw(10) << bytes / 1e6 << std::setw(11)
+                              << time.min * 1e3 << std::setw(11) << time.median * 1e3 << std::setw(11)
+                              << time.max * 1e3 << std::setw(10) << gbps.max << std::setw(10) << gbps.median
+                              << std::setw(10) << gbps.min << "  " << report.binding.name << "\n";
+                    json << (first_result ? "\n" : ",\n") << "{\"kernel\":\"" << benchmark.name
+                         << "\",\"size\":" << size << ",\"cores\":" << cores << ",\"tiles_per_cb\":" << tiles
+                         << ",\"bytes\":" << bytes << ",\"passed\":" << (result.passed() ? "true" : "false")
+                         << ",\"seconds\":{\"min\":" << time.min << ",\"median\":" << time.median
+                         << ",\"max\":" << time.max << "},\"gbps\":{\"min\":" << gbps.min
+                         << ",\"median\":" << gbps.median << ",\"max\":" << gbps.max << "},\"bound\":\""
+                         << report.binding.name << "\",\"dram_utilization\":" << report.resources[0].utilization
+                         << "}";
+                    first_result = false;
+                }
+            }
+        }
+    }
+    json << "\n]}\n";
+    std::cout << "Wrote " << json_path << "\n";
+    return all_passed ? 0 : 1;
+}
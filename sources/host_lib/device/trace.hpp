@@ -0,0 +1,80 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// Timestamp tracing for data movement and compute kernels. Every macro appends one 16-byte record (wall-clock cycles,
+// kind, id, argument) to this RISC's ring in L1, laid out as in host/trace_format.hpp; the host reads the rings back
+// after the program finishes and decodes them with current::host::decode_trace.
+//
+// The macros compile to nothing unless the kernel is built with the defines
+//   CURRENT_TRACE_ADDR      L1 address of the core's rings (the same on every core)
+//   CURRENT_TRACE_CAPACITY  records per ring
+// and the host has initialized the rings (current::host::empty_trace_rings) before the launch.
+//
+//   TRACE_ZONE_BEGIN(id) / TRACE_ZONE_END(id)  bracket a region; TRACE_SCOPE(id) does both for a C++ scope
+//   TRACE_MARK(id, value)                      an instant with a user value
+//   TRACE_NOC_READ(bytes) / TRACE_NOC_WRITE(bytes)  a NoC transaction being issued
+
+#include "../host/trace_format.hpp"
+
+#if defined(CURRENT_TRACE_ADDR) && defined(CURRENT_TRACE_CAPACITY)
+
+#include "risc_common.h"
+
+namespace current::trace {
+
+#if defined(COMPILE_FOR_BRISC)
+constexpr uint32_t TRACE_THIS_RISC = BRISC;
+#elif defined(COMPILE_FOR_NCRISC)
+constexpr uint32_t TRACE_THIS_RISC = NCRISC;
+#elif defined(COMPILE_FOR_TRISC)
+constexpr uint32_t TRACE_THIS_RISC = TRISC0 + COMPILE_FOR_TRISC;
+#else
+#error "device/trace.hpp: unknown RISC"
+#endif
+
+inline __attribute__((always_inline)) void trace_record(uint32_t tag, uint32_t arg) {
+    constexpr uint32_t ring = CURRENT_TRACE_ADDR + TRACE_THIS_RISC * trace_ring_bytes(CURRENT_TRACE_CAPACITY);
+    volatile TraceHeader *header = reinterpret_cast<volatile TraceHeader *>(ring);
+    uint32_t n = header->written;
+    volatile TraceRecord *record =
+        reinterpret_cast<volatile TraceRecord *>(ring + sizeof(TraceHeader)) + n % CURRENT_TRACE_CAPACITY;
+    // Reading the low word latches the high word.
+    record->time_lo = reg_read(RISCV_DEBUG_REG_WALL_CLOCK_L);
+    record->time_hi = reg_read(RISCV_DEBUG_REG_WALL_CLOCK_H);
+    record->tag = tag;
+    record->arg = arg;
+    header->written = n + 1;
+}
+
+struct TraceScope {
+    uint32_t id;
+    explicit TraceScope(uint32_t id) : id(id) { trace_record(trace_tag(ZONE_BEGIN, id), 0); }
+    ~TraceScope() { trace_record(trace_tag(ZONE_END, id), 0); }
+};
+
+}  // namespace current::trace
+
+#define TRACE_RECORD(kind, id, arg) \
+    current::trace::trace_record(current::trace::trace_tag(current::trace::kind, id), arg)
+#define TRACE_ZONE_BEGIN(id) TRACE_RECORD(ZONE_BEGIN, id, 0)
+#define TRACE_ZONE_END(id) TRACE_RECORD(ZONE_END, id, 0)
+#define TRACE_MARK(id, value) TRACE_RECORD(MARK, id, value)
+#define TRACE_NOC_READ(bytes) TRACE_RECORD(NOC_READ, 0, bytes)
+#define TRACE_NOC_WRITE(bytes) TRACE_RECORD(NOC_WRITE, 0, bytes)
+#define TRACE_SCOPE_CONCAT(a, b) a##b
+#define TRACE_SCOPE_NAME(line) TRACE_SCOPE_CONCAT(trace_scope_, line)
+#define TRACE_SCOPE(id) current::trace::TraceScope TRACE_SCOPE_NAME(__LINE__)(id)
+
+#else
+
+#define TRACE_ZONE_BEGIN(id)
+#define TRACE_ZONE_END(id)
+#define TRACE_MARK(id, value)
+#define TRACE_NOC_READ(bytes)
+#define TRACE_NOC_WRITE(bytes)
+#define TRACE_SCOPE(id)
+
+#endif
@@ -0,0 +1,179 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "bf16.hpp"
+
+#include <immintrin.h>
+
+#include <algorithm>
+#include <cassert>
+
+#include "thread_pool.hpp"
+
+namespace current::host {
+
+namespace {
+
+void unpack_scalar(const uint32_t *packed, size_t first, size_t n, float *out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = bf16_to_float(packed_bf16_at(packed, first + i));
+    }
+}
+
+void pack_scalar(const float *in, size_t n, uint32_t *packed, size_t first, Rounding rounding) {
+    for (size_t i = 0; i < n; i++) {
+        size_t index = first + i;
+        uint32_t shift = 16 * (index & 1);
+        uint32_t &word = packed[index / 2];
+        word = (word & ~(0xFFFFU << shift)) | (static_cast<uint32_t>(float_to_bf16(in[i], rounding)) << shift);
+    }
+}
+
+void round_scalar(float *data, size_t n, Rounding rounding) {
+    for (size_t i = 0; i < n; i++) {
+        data[i] = bf16_to_float(float_to_bf16(data[i], rounding));
+    }
+}
+
+// Rounds 8 fp32 lanes to bf16, leaving the result in the upper 16 bits of each lane.
+__attribute__((target("avx2"))) inline __m256i round_lanes_avx2(__m256i bits, Rounding rounding) {
+    if (rounding == Rounding::Truncate) {
+        return _mm256_and_si256(bits, _mm256_set1_epi32(static_cast<int>(0xFFFF0000U)));
+    }
+    __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+    __m256i rounded = _mm256_add_epi32(bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7FFF)));
+    rounded = _mm256_and_si256(rounded, _mm256_set1_epi32(static_cast<int>(0xFFFF0000U)));
+    // NaN lanes: quiet them instead of rounding.
+    __m256i abs = _mm256_and_si256(bits, _mm256_set1_epi32(0x7FFFFFFF));
+    __m256i is_nan = _mm256_cmpgt_epi32(abs, _mm256_set1_epi32(0x7F800000));
+    __m256i nan = _mm256_or_si256(
+        _mm256_and_si256(bits, _mm256_set1_epi32(static_cast<int>(0xFFFF0000U))), _mm256_set1_epi32(0x00400000));
+    return _mm256_blendv_epi8(rounded, nan, is_nan);
+}
+
+__attribute__((target("avx2"))) void unpack_avx2(const uint32_t *packed, size_t first, size_t n, float *out) {
+    const uint32_t *src = packed + first / 2;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m128i half = _mm_loadu_si128(reinterpret_cast<const __m128i *>(src + i / 2));
+        __m256i wide = _mm256_slli_epi32(_mm256_cvtepu16_epi32(half), 16);
+        _mm256_storeu_ps(out + i, _mm256_castsi256_ps(wide));
+    }
+    unpack_scalar(packed, first + i, n - i, out + i);
+}
+
+__attribute__((target("avx2"))) void pack_avx2(
+    const float *in, size_t n, uint32_t *packed, size_t first, Rounding rounding) {
+    uint32_t *dst = packed + first / 2;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i lo = round_lanes_avx2(_mm256_castps_si256(_mm256_loadu_ps(in + i)), rounding);
+        __m256i hi = round_lanes_avx2(_mm256_castps_si256(_mm256_loadu_ps(in + i + 8)), rounding);
+        __m256i words = _mm256_packus_epi32(_mm256_srli_epi32(lo, 16), _mm256_srli_epi32(hi, 16));
+        words = _mm256_permute4x64_epi64(words, 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i / 2), words);
+    }
+    pack_scalar(in + i, n - i, packed, first + i, rounding);
+}
+
+__attribute__((target("avx2"))) void round_avx2(float *data, size_t n, Rounding rounding) {
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256i bits = round_lanes_avx2(_mm256_castps_si256(_mm256_loadu_ps(data + i)), rounding);
+        _mm256_storeu_ps(data + i, _mm256_castsi256_ps(bits));
+    }
+    round_scalar(data + i, n - i, rounding);
+}
+
+__attribute__((target("avx512f"))) void unpack_avx512(const uint32_t *packed, size_t first, size_t n, float *out) {
+    const uint32_t *src = packed + first / 2;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256i half = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(src + i / 2));
+        __m512i wide = _mm512_slli_epi32(_mm512_cvtepu16_epi32(half), 16);
+        _mm512_storeu_ps(out + i, _mm512_castsi512_ps(wide));
+    }
+    unpack_avx2(packed, first + i, n - i, out + i);
+}
+
+// Native bf16 conversion (round-to-nearest-even) on Cooper Lake / Sapphire Rapids / Zen 4.
+__attribute__((target("avx512f,avx512bf16"))) void pack_avx512bf16(
+    const float *in, size_t n, uint32_t *packed, size_t first) {
+    uint32_t *dst = packed + first / 2;
+    size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        __m256bh converted = _mm512_cvtneps_pbh(_mm512_loadu_ps(in + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(dst + i / 2), (__m256i)converted);
+    }
+    pack_avx2(in + i, n - i, packed, first + i, Rounding::NearestEven);
+}
+
+struct Isa {
+    bool avx2 = false;
+    bool avx512f = false;
+    bool avx512bf16 = false;
+};
+
+const Isa &isa() {
+    static const Isa detected = [] {
+        Isa result;
+        __builtin_cpu_init();
+        result.avx2 = __builtin_cpu_supports("avx2");
+        result.avx512f = result.avx2 && __builtin_cpu_supports("avx512f");
+        result.avx512bf16 = result.avx512f && __builtin_cpu_supports("avx512bf16");
+        return result;
+    }();
+    return detected;
+}
+
+}  // namespace
+
+void unpack_bf16(const uint32_t *packed, size_t first, size_t n, float *out) {
+    assert(first % 2 == 0);
+    if (isa().avx512f) {
+        unpack_avx512(packed, first, n, out);
+    } else if (isa().avx2) {
+        unpack_avx2(packed, first, n, out);
+    } else {
+        unpack_scalar(packed, first, n, out);
+    }
+}
+
+void pack_bf16(const float *in, size_t n, uint32_t *packed, size_t first, Rounding rounding) {
+    assert(first % 2 == 0);
+    if (isa().avx512bf16 && rounding == Rounding::NearestEven) {
+        pack_avx512bf16(in, n, packed, first);
+    } else if (isa().avx2) {
+        pack_avx2(in, n, packed, first, rounding);
+    } else {
+        pack_scalar(in, n, packed, first, rounding);
+    }
+}
+
+std::vector<float> unpack_bf16_vec(const std::vector<uint32_t> &packed) {
+    std::vector<float> values(packed.size() * 2);
+    ThreadPool::global().parallel_for(packed.size(), 1 << 14, [&](size_t begin, size_t end) {
+        unpack_bf16(packed.data(), begin * 2, (end - begin) * 2, values.data() + begin * 2);
+    });
+    return values;
+}
+
+std::vector<uint32_t> pack_bf16_vec(const std::vector<float> &values, Rounding rounding) {
+    std::vector<uint32_t> packed((values.size() + 1) / 2, 0);
+    ThreadPool::global().parallel_for(packed.size(), 1 << 14, [&](size_t begin, size_t end) {
+        size_t n = std::min(values.size(), end * 2) - begin * 2;
+        pack_bf16(values.data() + begin * 2, n, packed.data(), begin * 2, rounding);
+    });
+    return packed;
+}
+
+void round_to_bf16(float *data, size_t n, Rounding rounding) {
+    if (isa().avx2) {
+        round_avx2(data, n, rounding);
+    } else {
+        round_scalar(data, n, rounding);
+    }
+}
+
+}  // namespace current::host
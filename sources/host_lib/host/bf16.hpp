@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace current::host {
+
+// Streams hold bf16 data packed two per uint32 (element 2i in the low half), the same layout produced by
+// pack_bfloat16_vec_into_uint32_vec.
+
+enum class Rounding {
+    NearestEven,  // What the packer does on device.
+    Truncate,     // What tt_metal's bfloat16(float) constructor does.
+};
+
+inline float bf16_to_float(uint16_t value) { return std::bit_cast<float>(static_cast<uint32_t>(value) << 16); }
+
+inline uint16_t float_to_bf16(float value, Rounding rounding = Rounding::NearestEven) {
+    uint32_t bits = std::bit_cast<uint32_t>(value);
+    if (rounding == Rounding::Truncate) {
+        return static_cast<uint16_t>(bits >> 16);
+    }
+    if ((bits & 0x7FFFFFFFU) > 0x7F800000U) {
+        // Keep NaNs quiet instead of letting the rounding carry turn them into infinities.
+        return static_cast<uint16_t>((bits >> 16) | 0x40U);
+    }
+    bits += 0x7FFFU + ((bits >> 16) & 1U);
+    return static_cast<uint16_t>(bits >> 16);
+}
+
+// Element `index` of a packed bf16 buffer.
+inline uint16_t packed_bf16_at(const uint32_t *packed, size_t index) {
+    return static_cast<uint16_t>(packed[index / 2] >> (16 * (index & 1)));
+}
+
+// Bulk conversions. These dispatch at runtime to AVX-512/AVX2 when the host supports them.
+// `first` is the element offset into `packed` and must be even.
+void unpack_bf16(const uint32_t *packed, size_t first, size_t n, float *out);
+void pack_bf16(const float *in, size_t n, uint32_t *packed, size_t first, Rounding rounding = Rounding::NearestEven);
+
+// Whole-vector conversions, split across the global thread pool. Drop-in replacements for
+// unpack_uint32_vec_into_bfloat16_vec / pack_bfloat16_vec_into_uint32_vec that work on fp32 directly.
+std::vector<float> unpack_bf16_vec(const std::vector<uint32_t> &packed);
+std::vector<uint32_t> pack_bf16_vec(const std::vector<float> &values, Rounding rounding = Rounding::NearestEven);
+
+// Rounds fp32 values in place to the nearest bf16-representable value, emulating a bf16 register after every op.
+void round_to_bf16(float *data, size_t n, Rounding rounding = Rounding::NearestEven);
+
+}  // namespace current::host
@@ -0,0 +1,47 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "chunk_pipeline.hpp"
+
+#include <exception>
+#include <future>
+
+namespace current::host {
+
+void run_double_buffered(size_t num_chunks, const ChunkPhases &phases) {
+    // Step s writes chunk s, executes chunk s - 1 and reads chunk s - 2. Chunks s and s - 2 share a slot, but one is
+    // an input slot and the other an output slot, so the three phases never touch the same buffer.
+    for (size_t step = 0; step < num_chunks + 2; step++) {
+        std::future<void> write;
+        std::future<void> read;
+        if (step < num_chunks) {
+            write = std::async(std::launch::async, phases.write, step, step % 2);
+        }
+        if (step >= 2) {
+            read = std::async(std::launch::async, phases.read, step - 2, step % 2);
+        }
+        std::exception_ptr error;
+        if (step >= 1 && step <= num_chunks) {
+            try {
+                phases.execute(step - 1, (step - 1) % 2);
+            } catch (...) {
+                error = std::current_exception();
+            }
+        }
+        for (auto *transfer : {&write, &read}) {
+            if (transfer->valid()) {
+                try {
+                    transfer->get();
+                } catch (...) {
+                    error = error != nullptr ? error : std::current_exception();
+                }
+            }
+        }
+        if (error != nullptr) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+}  // namespace current::host
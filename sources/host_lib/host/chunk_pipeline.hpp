@@ -0,0 +1,27 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <functional>
+
+namespace current::host {
+
+// The three phases of streaming one chunk through a device. Each is called with the chunk number and the buffer slot
+// (0 or 1) it owns: `write` fills input slot `slot` (host -> device), `execute` reads input slot `slot` and fills
+// output slot `slot`, `read` drains output slot `slot` (device -> host).
+struct ChunkPhases {
+    std::function<void(size_t chunk, size_t slot)> write;
+    std::function<void(size_t chunk, size_t slot)> execute;
+    std::function<void(size_t chunk, size_t slot)> read;
+};
+
+// Runs `num_chunks` chunks through a double-buffered pipeline: while chunk i executes, chunk i + 1 is written into the
+// other input slot and chunk i - 1 is read out of the other output slot. Only two slots per direction are ever live,
+// so memory is bounded by the chunk size rather than the stream length. `execute` runs on the calling thread; the
+// transfers run on helper threads. The first exception thrown by any phase is rethrown after the step finishes.
+void run_double_buffered(size_t num_chunks, const ChunkPhases &phases);
+
+}  // namespace current::host
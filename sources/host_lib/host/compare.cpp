@@ -0,0 +1,185 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "compare.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <functional>
+#include <mutex>
+#include <sstream>
+
+#include "bf16.hpp"
+#include "thread_pool.hpp"
+
+namespace current::host {
+
+namespace {
+
+constexpr size_t BLOCK = 1024;
+
+// Maps bf16 bits onto a line where adjacent representable values differ by one.
+int32_t ordered(uint16_t bits) {
+    return (bits & 0x8000U) != 0 ? 0x8000 - static_cast<int32_t>(bits & 0x7FFFU)
+                                 : 0x8000 + static_cast<int32_t>(bits);
+}
+
+struct BlockStats {
+    size_t mismatches = 0;
+    float max_abs = 0.0F;
+    float max_rel = 0.0F;
+};
+
+// Branch-free error statistics for one block; vectorizes under each target.
+__attribute__((target_clones("avx512f", "avx2", "default"))) BlockStats block_stats(
+    const float *expected, const float *actual, size_t n, float rtol, float atol) {
+    BlockStats stats;
+    for (size_t i = 0; i < n; i++) {
+        float diff = std::fabs(expected[i] - actual[i]);
+        float denom = std::max(std::fabs(expected[i]), std::fabs(actual[i]));
+        bool ok = diff <= atol || diff < rtol * denom;
+        stats.mismatches += ok ? 0 : 1;
+        stats.max_abs = std::max(stats.max_abs, diff);
+        stats.max_rel = std::max(stats.max_rel, denom > 0.0F ? diff / denom : 0.0F);
+    }
+    return stats;
+}
+
+struct Partial {
+    size_t begin = 0;
+    CompareResult result;
+};
+
+CompareResult compare_impl(
+    const std::function<void(size_t, size_t, float *)> &load_expected,
+    const std::vector<uint32_t> &actual,
+    size_t count,
+    const CompareOptions &options) {
+    count = std::min(count, actual.size() * 2);
+    std::mutex mutex;
+    std::vector<Partial> partials;
+
+    ThreadPool::global().parallel_for((count + BLOCK - 1) / BLOCK, 16, [&](size_t block_begin, size_t block_end) {
+        Partial partial;
+        partial.begin = block_begin;
+        auto &result = partial.result;
+        std::vector<float> expected_block(BLOCK);
+        std::vector<float> actual_block(BLOCK);
+        for (size_t block = block_begin; block < block_end; block++) {
+            size_t first = block * BLOCK;
+            size_t n = std::min(BLOCK, count - first);
+            load_expected(first, n, expected_block.data());
+            unpack_bf16(actual.data(), first, n, actual_block.data());
+
+            auto stats = block_stats(expected_block.data(), actual_block.data(), n, options.rtol, options.atol);
+            result.count += n;
+            result.mismatches += stats.mismatches;
+            result.max_rel_error = std::max(result.max_rel_error, stats.max_rel);
+            bool need_max_index = stats.max_abs > result.max_abs_error;
+            result.max_abs_error = std::max(result.max_abs_error, stats.max_abs);
+
+            for (size_t i = 0; i < n; i++) {
+                float e = expected_block[i];
+                float a = actual_block[i];
+                int32_t distance = std::abs(ordered(float_to_bf16(e)) - ordered(float_to_bf16(a)));
+                size_t bucket = std::isnan(e) || std::isnan(a)
+                                    ? CompareResult::ULP_BUCKETS - 1
+                                    : std::min<size_t>(std::bit_width(static_cast<uint32_t>(distance)),
+                                                       CompareResult::ULP_BUCKETS - 1);
+                result.ulp_histogram[bucket]++;
+                if (need_max_index && std::fabs(e - a) == stats.max_abs) {
+                    result.max_abs_error_index = first + i;
+                    need_max_index = false;
+                }
+            }
+            if (stats.mismatches > 0 && result.first_mismatches.size() < options.max_reported) {
+                for (size_t i = 0; i < n && result.first_mismatches.size() < options.max_reported; i++) {
+                    float e = expected_block[i];
+                    float a = actual_block[i];
+                    float diff = std::fabs(e - a);
+                    if (!(diff <= options.atol || diff < options.rtol * std::max(std::fabs(e), std::fabs(a)))) {
+                        result.first_mismatches.push_back({first + i, e, a});
+                    }
+                }
+            }
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        partials.push_back(std::move(partial));
+    });
+
+    std::sort(partials.begin(), partials.end(), [](const Partial &a, const Partial &b) { return a.begin < b.begin; });
+    CompareResult total;
+    for (auto &partial : partials) {
+        const auto &r = partial.result;
+        total.count += r.count;
+        total.mismatches += r.mismatches;
+        total.max_rel_error = std::max(total.max_rel_error, r.max_rel_error);
+        if (r.max_abs_error > total.max_abs_error) {
+            total.max_abs_error = r.max_abs_error;
+            total.max_abs_error_index = r.max_abs_error_index;
+        }
+        for (size_t b = 0; b < CompareResult::ULP_BUCKETS; b++) {
+            total.ulp_histogram[b] += r.ulp_histogram[b];
+        }
+        for (const auto &m : r.first_mismatches) {
+            if (total.first_mismatches.size() < options.max_reported) {
+                total.first_mismatches.push_back(m);
+            }
+        }
+    }
+    return total;
+}
+
+}  // namespace
+
+CompareResult compare_bf16(
+    const std::vector<uint32_t> &expected,
+    const std::vector<uint32_t> &actual,
+    size_t count,
+    const CompareOptions &options) {
+    count = std::min(count, expected.size() * 2);
+    return compare_impl(
+        [&](size_t first, size_t n, float *out) { unpack_bf16(expected.data(), first, n, out); },
+        actual,
+        count,
+        options);
+}
+
+CompareResult compare_bf16(
+    const std::vector<float> &expected,
+    const std::vector<uint32_t> &actual,
+    size_t count,
+    const CompareOptions &options) {
+    count = std::min(count, expected.size());
+    return compare_impl(
+        [&](size_t first, size_t n, float *out) { std::copy_n(expected.begin() + first, n, out); },
+        actual,
+        count,
+        options);
+}
+
+std::string CompareResult::summary() const {
+    std::ostringstream out;
+    out << (passed() ? "PASS" : "FAIL") << ": " << mismatches << "/" << count << " mismatches"
+        << ", max abs err " << max_abs_error << " (index " << max_abs_error_index << ")"
+        << ", max rel err " << max_rel_error << "\n";
+    out << "  ulp histogram:";
+    for (size_t b = 0; b < ULP_BUCKETS; b++) {
+        if (b == 0) {
+            out << " [0]=" << ulp_histogram[b];
+        } else if (b == ULP_BUCKETS - 1) {
+            out << " [>=" << (1U << (b - 1)) << "]=" << ulp_histogram[b];
+        } else {
+            out << " [" << (1U << (b - 1)) << "," << (1U << b) << ")=" << ulp_histogram[b];
+        }
+    }
+    out << "\n";
+    for (const auto &m : first_mismatches) {
+        out << "  " << m.index << ": expected " << m.expected << ", got " << m.actual << "\n";
+    }
+    return out.str();
+}
+
+}  // namespace current::host
@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace current::host {
+
+struct CompareOptions {
+    // Same criterion as is_close(): |a - b| <= atol || |a - b| < rtol * max(|a|, |b|).
+    float rtol = 0.01F;
+    float atol = 0.001F;
+    // How many mismatches to keep details for (lowest indices first).
+    size_t max_reported = 16;
+};
+
+struct Mismatch {
+    size_t index;
+    float expected;
+    float actual;
+};
+
+// Summary of a bulk comparison, meant to be printed once instead of per element.
+struct CompareResult {
+    // ULP distance between expected (rounded to bf16) and actual: bucket 0 is exact, bucket k >= 1 counts distances in
+    // [2^(k-1), 2^k), and the last bucket collects everything larger (including NaN disagreement).
+    static constexpr size_t ULP_BUCKETS = 10;
+
+    size_t count = 0;
+    size_t mismatches = 0;
+    float max_abs_error = 0.0F;
+    float max_rel_error = 0.0F;
+    size_t max_abs_error_index = 0;
+    std::array<size_t, ULP_BUCKETS> ulp_histogram{};
+    std::vector<Mismatch> first_mismatches;
+
+    bool passed() const { return mismatches == 0; }
+    std::string summary() const;
+};
+
+// Compares `count` bf16 values packed in `actual` against packed bf16 `expected`.
+CompareResult compare_bf16(
+    const std::vector<uint32_t> &expected,
+    const std::vector<uint32_t> &actual,
+    size_t count,
+    const CompareOptions &options = {});
+
+// Compares `count` bf16 values packed in `actual` against fp32 reference values.
+CompareResult compare_bf16(
+    const std::vector<float> &expected,
+    const std::vector<uint32_t> &actual,
+    size_t count,
+    const CompareOptions &options = {});
+
+}  // namespace current::host
@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "convolution.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "thread_pool.hpp"
+
+namespace current::host {
+
+namespace {
+
+// Rows per band are kept even so every band starts on a packed word; this many row pairs is the smallest band.
+constexpr size_t MIN_BAND_PAIRS = 16;
+
+// Coordinate that position `pos` of a `size`-long axis reads, or -1 for a 0.
+int64_t resolve(int64_t pos, int64_t size, Boundary boundary) {
+    if (pos >= 0 && pos < size) {
+        return pos;
+    }
+    switch (boundary) {
+        case Boundary::Clamp: return std::clamp<int64_t>(pos, 0, size - 1);
+        case Boundary::Zero: return -1;
+        case Boundary::Wrap: return (pos % size + size) % size;
+    }
+    return -1;
+}
+
+__attribute__((target_clones("avx512f", "avx2", "default"))) void accumulate(
+    float weight, const float *in, float *out, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] += weight * in[i];
+}
+
+void check_taps(const std::vector<float> &taps) {
+    if (taps.empty() || taps.size() % 2 == 0) {
+        throw std::invalid_argument("convolve_separable: filters need an odd, non-zero number of taps");
+    }
+}
+
+}  // namespace
+
+SeparableFilter SeparableFilter::box(uint32_t radius_x, uint32_t radius_y) {
+    SeparableFilter filter;
+    filter.horizontal.assign(2 * radius_x + 1, 1.0F / static_cast<float>(2 * radius_x + 1));
+    filter.vertical.assign(2 * radius_y + 1, 1.0F / static_cast<float>(2 * radius_y + 1));
+    return filter;
+}
+
+std::vector<uint32_t> convolve_separable(
+    const std::vector<uint32_t> &image,
+    uint32_t width,
+    uint32_t height,
+    const SeparableFilter &filter,
+    Boundary boundary,
+    Rounding rounding) {
+    check_taps(filter.horizontal);
+    check_taps(filter.vertical);
+    size_t pixels = size_t{width} * height;
+    if (image.size() * 2 < pixels) {
+        throw std::invalid_argument("convolve_separable: image is smaller than width * height");
+    }
+    std::vector<uint32_t> out((pixels + 1) / 2, 0);
+    if (pixels == 0) {
+        return out;
+    }
+
+    auto rx = static_cast<int64_t>(filter.horizontal.size() / 2);
+    auto ry = static_cast<int64_t>(filter.vertical.size() / 2);
+    size_t window = filter.vertical.size();
+    ThreadPool::global().parallel_for((height + 1) / 2, MIN_BAND_PAIRS, [&](size_t pair_begin, size_t pair_end) {
+        int64_t y0 = static_cast<int64_t>(pair_begin) * 2;
+        int64_t y1 = std::min<int64_t>(static_cast<int64_t>(pair_end) * 2, height);
+        std::vector<float> raw(width + 1);
+        std::vector<float> line(width + 2 * rx);
+        std::vector<float> ring(window * width);
+        std::vector<float> band((y1 - y0) * width);
+
+        // Row pass over source row y (already resolved) into `dst`; the padded line holds the row plus its halo.
+        auto filter_row = [&](int64_t y, float *dst) {
+            std::fill_n(dst, width, 0.0F);
+            if (y < 0) {
+                return;
+            }
+            size_t begin = y * width;
+            size_t aligned = begin & ~size_t{1};
+            unpack_bf16(image.data(), aligned, width + begin - aligned, raw.data());
+            const float *row = raw.data() + (begin - aligned);
+            std::copy_n(row, width, line.begin() + rx);
+            for (int64_t p = 1; p <= rx; p++) {
+                int64_t left = resolve(-p, width, boundary);
+                int64_t right = resolve(width - 1 + p, width, boundary);
+                line[rx - p] = left < 0 ? 0.0F : row[left];
+                line[rx + width - 1 + p] = right < 0 ? 0.0F : row[right];
+            }
+            for (size_t k = 0; k < filter.horizontal.size(); k++) {
+                accumulate(filter.horizontal[k], line.data() + k, dst, width);
+            }
+            round_to_bf16(dst, width, rounding);
+        };
+        auto ring_row = [&](int64_t y) {
+            return ring.data() + static_cast<size_t>((y % static_cast<int64_t>(window) + window) % window) * width;
+        };
+
+        // Prime the window with the rows above the band, then slide it: each output row filters one new row.
+        for (int64_t y = y0 - ry; y < y0 + ry; y++) {
+            filter_row(resolve(y, height, boundary), ring_row(y));
+        }
+        for (int64_t y = y0; y < y1; y++) {
+            filter_row(resolve(y + ry, height, boundary), ring_row(y + ry));
+            float *dst = band.data() + (y - y0) * width;
+            for (size_t k = 0; k < window; k++) {
+                accumulate(filter.vertical[k], ring_row(y - ry + static_cast<int64_t>(k)), dst, width);
+            }
+        }
+        pack_bf16(band.data(), band.size(), out.data(), y0 * width, rounding);
+    });
+    return out;
+}
+
+}  // namespace current::host
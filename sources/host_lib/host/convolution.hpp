@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "bf16.hpp"
+#include "cpu_map.hpp"
+
+namespace current::host {
+
+// A 2D filter that factors into a row pass and a column pass. Each has 2 * radius + 1 taps, centered: tap k weights
+// the pixel at offset k - radius.
+struct SeparableFilter {
+    std::vector<float> horizontal;
+    std::vector<float> vertical = {1.0F};  // Radius 0: a 1D (row-only) filter.
+
+    // Mean over a (2 * radius_x + 1) x (2 * radius_y + 1) window.
+    static SeparableFilter box(uint32_t radius_x, uint32_t radius_y = 0);
+};
+
+// Convolves a row-major width x height bf16 image (packed two per word) with `filter`; taps outside the image follow
+// `boundary` as for a StencilStream.
+//
+// Instead of gathering every tap of every pixel, each band of rows slides a window of 2 * radius_y + 1 row-filtered
+// rows down the image: every input row is read and row-filtered once per band, and each output row only adds the
+// rows already in the window. The row pass is rounded to bf16 as the L1 intermediate would be; both passes accumulate
+// in fp32. Throws std::invalid_argument for an empty or even-length tap list or an image smaller than width * height.
+std::vector<uint32_t> convolve_separable(
+    const std::vector<uint32_t> &image,
+    uint32_t width,
+    uint32_t height,
+    const SeparableFilter &filter,
+    Boundary boundary = Boundary::Zero,
+    Rounding rounding = Rounding::NearestEven);
+
+}  // namespace current::host
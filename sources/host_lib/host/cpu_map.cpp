@@ -0,0 +1,1292 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "cpu_map.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include "chunk_pipeline.hpp"
+#include "expr.hpp"
+
+namespace current::host {
+
+namespace {
+
+constexpr size_t TILE_SIZE = 1024;
+// StageInput / ValueSource access that reads a CSR gather token's arity (the `count` input).
+constexpr uint32_t COUNT_ACCESS = UINT32_MAX;
+
+// Where one kernel input value comes from.
+struct ValueSource {
+    const uint32_t *packed = nullptr;  // Plain stream / upstream kernel output.
+    const float *table = nullptr;      // Gather table, already widened to fp32 ...
+    const uint32_t *packed_table = nullptr;  // ... or, when memory-mapped, read as bf16 straight from the mapping.
+    const uint32_t *indices = nullptr;
+    size_t table_size = 0;
+    uint8_t stride = 1;
+    uint32_t access = 0;
+    const uint32_t *csr_offsets = nullptr;  // CSR gather: per-token offsets; `indices` starts at csr_offsets[0].
+    const uint32_t *read_offsets = nullptr;  // Reordered gather: where each read lands within its tile.
+    size_t tokens = 0;                       // Gather tokens from the base of `indices`.
+    const StencilStream *stencil = nullptr;  // Stencil: `table` is the image, `access` the tap ...
+    size_t token_base = 0;                   // ... and this the stream position of token 0.
+
+    float table_at(size_t index) const {
+        return table != nullptr ? table[index] : bf16_to_float(packed_bf16_at(packed_table, index));
+    }
+};
+
+__attribute__((target_clones("avx512f", "avx2", "default"))) void apply(
+    expr::Op op, const float *lhs, const float *rhs, float *out, size_t n) {
+    switch (op) {
+        case expr::Op::Add:
+            for (size_t i = 0; i < n; i++) out[i] = lhs[i] + rhs[i];
+            break;
+        case expr::Op::Sub:
+            for (size_t i = 0; i < n; i++) out[i] = lhs[i] - rhs[i];
+            break;
+        case expr::Op::Mul:
+            for (size_t i = 0; i < n; i++) out[i] = lhs[i] * rhs[i];
+            break;
+        case expr::Op::Div:
+            for (size_t i = 0; i < n; i++) out[i] = lhs[i] / rhs[i];
+            break;
+        case expr::Op::Neg:
+            for (size_t i = 0; i < n; i++) out[i] = -lhs[i];
+            break;
+        default: break;
+    }
+}
+
+// Per-thread evaluation state for one kernel: one tile-sized fp32 vector per IR node.
+struct TileEvaluator {
+    explicit TileEvaluator(size_t num_nodes) : values(num_nodes) {}
+
+    void load(const ValueSource &source, size_t first, size_t n, float *out) const {
+        if (source.packed != nullptr) {
+            unpack_bf16(source.packed, first, n, out);
+            return;
+        }
+        if (source.stencil != nullptr) {
+            // Addresses come from the token's coordinates; nothing was staged for them.
+            for (size_t i = 0; i < n; i++) {
+                int64_t index = source.stencil->neighbor(source.token_base + first + i, source.access);
+                out[i] = index < 0 ? 0.0F : source.table_at(index);
+            }
+            return;
+        }
+        if (source.csr_offsets != nullptr) {
+            uint32_t origin = source.csr_offsets[0];
+            for (size_t i = 0; i < n; i++) {
+                uint32_t begin = source.csr_offsets[first + i] - origin;
+                uint32_t arity = source.csr_offsets[first + i + 1] - source.csr_offsets[first + i];
+                if (source.access == COUNT_ACCESS) {
+                    out[i] = static_cast<float>(arity);
+                } else if (source.access < arity) {
+                    uint32_t index = source.indices[begin + source.access];
+                    out[i] = index < source.table_size ? source.table_at(index) : 0.0F;
+                } else {
+                    out[i] = 0.0F;
+                }
+            }
+            return;
+        }
+        if (source.read_offsets != nullptr) {
+            // Walk the tile's reads in planned order and scatter this access's values back to token order.
+            size_t base = first * source.stride;
+            size_t reads = std::min(TILE_SIZE, source.tokens - first) * source.stride;
+            for (size_t r = 0; r < reads; r++) {
+                uint32_t offset = source.read_offsets[base + r];
+                size_t token = offset / source.stride;
+                if (offset % source.stride == source.access && token < n) {
+                    uint32_t index = source.indices[base + r];
+                    out[token] = index < source.table_size ? source.table_at(index) : 0.0F;
+                }
+            }
+            return;
+        }
+        for (size_t i = 0; i < n; i++) {
+            uint32_t index = source.indices[(first + i) * source.stride + source.access];
+            out[i] = index < source.table_size ? source.table_at(index) : 0.0F;
+        }
+    }
+
+    std::vector<std::array<float, TILE_SIZE>> values;
+};
+
+// Tokens in a fixed-arity gather of `reads` indices. Checked before the division, so it can run in an initializer.
+uint32_t gather_token_count(size_t reads, uint8_t accesses_per_token) {
+    if (accesses_per_token == 0 || reads % accesses_per_token != 0) {
+        throw std::invalid_argument("GatherStream: accesses per token must evenly divide the index vector");
+    }
+    return static_cast<uint32_t>(reads / accesses_per_token);
+}
+
+}  // namespace
+
+GatherStream::GatherStream(
+    const std::vector<uint32_t> &table,
+    uint32_t table_n_elements,
+    const std::vector<uint32_t> &index_vec,
+    uint8_t accesses_per_token) :
+    Stream(table, gather_token_count(index_vec.size(), accesses_per_token)),
+    indices(index_vec),
+    accesses_per_token(accesses_per_token) {
+    if (table_n_elements > table.size() * 2) {
+        throw std::invalid_argument("GatherStream: table is smaller than table_n_elements");
+    }
+    data.resize((table_n_elements + 1) / 2);
+}
+
+GatherStream::GatherStream(
+    const std::vector<uint32_t> &table,
+    uint32_t table_n_elements,
+    const std::vector<uint32_t> &offsets,
+    const std::vector<uint32_t> &index_vec) :
+    Stream(table, static_cast<uint32_t>(offsets.empty() ? 0 : offsets.size() - 1)),
+    indices(index_vec),
+    accesses_per_token(1),
+    csr_offsets(offsets) {
+    if (offsets.empty() || offsets.front() != 0 || offsets.back() != index_vec.size()) {
+        throw std::invalid_argument("GatherStream: CSR offsets must run from 0 to the index vector size");
+    }
+    for (size_t t = 0; t + 1 < offsets.size(); t++) {
+        if (offsets[t + 1] < offsets[t]) {
+            throw std::invalid_argument("GatherStream: CSR offsets must be non-decreasing");
+        }
+        arity_max = std::max(arity_max, offsets[t + 1] - offsets[t]);
+    }
+    if (table_n_elements > table.size() * 2) {
+        throw std::invalid_argument("GatherStream: table is smaller than table_n_elements");
+    }
+    data.resize((table_n_elements + 1) / 2);
+}
+
+ScatterStream::ScatterStream(
+    const std::vector<uint32_t> &table,
+    uint32_t table_n_elements,
+    const std::vector<uint32_t> &index_vec,
+    ScatterOp op) :
+    Stream(table, static_cast<uint32_t>(index_vec.size())),
+    indices(index_vec),
+    table_n_elements(table_n_elements),
+    scatter_op(op) {
+    if (table_n_elements > table.size() * 2) {
+        throw std::invalid_argument("ScatterStream: table is smaller than table_n_elements");
+    }
+    if (std::any_of(index_vec.begin(), index_vec.end(), [&](uint32_t index) { return index >= table_n_elements; })) {
+        throw std::invalid_argument("ScatterStream: index outside the table");
+    }
+    data.resize((table_n_elements + 1) / 2);
+}
+
+ReduceStream::ReduceStream(ReduceOp op, uint32_t count, uint32_t group_size) :
+    Stream({}, count), reduce_op(op), group_size(group_size == 0 ? std::max(count, 1U) : group_size) {
+    partials.assign((count + this->group_size - 1) / this->group_size, identity());
+    data.resize((partials.size() + 1) / 2);
+}
+
+ReduceStream::Partial ReduceStream::identity() const {
+    switch (reduce_op) {
+        case ReduceOp::Min: return {std::numeric_limits<float>::infinity(), 0, 0};
+        case ReduceOp::Max:
+        case ReduceOp::ArgMax: return {-std::numeric_limits<float>::infinity(), UINT32_MAX, 0};
+        default: return {0.0F, 0, 0};
+    }
+}
+
+ReduceStream::Partial ReduceStream::combine(const Partial &a, const Partial &b) const {
+    Partial out = a;
+    out.count = a.count + b.count;
+    switch (reduce_op) {
+        case ReduceOp::Sum:
+        case ReduceOp::Mean: out.value = a.value + b.value; break;
+        case ReduceOp::Min: out.value = std::min(a.value, b.value); break;
+        case ReduceOp::Max: out.value = std::max(a.value, b.value); break;
+        case ReduceOp::ArgMax:
+            if (b.value > a.value || (b.value == a.value && b.index < a.index)) {
+                out.value = b.value;
+                out.index = b.index;
+            }
+            break;
+    }
+    return out;
+}
+
+void ReduceStream::accumulate(
+    const uint32_t *packed, size_t first, size_t n, const WorkSplit &split, ThreadPool &pool) {
+    if (n == 0) {
+        return;
+    }
+    // Core c reduces tokens [begin, end) of the chunk into one partial per group it touches, from group_begin[c] on.
+    std::vector<std::vector<Partial>> core_partials(split.cores.size());
+    std::vector<size_t> group_begin(split.cores.size());
+    pool.parallel_for(split.cores.size(), 1, [&](size_t core_begin, size_t core_end) {
+        std::array<float, TILE_SIZE> values;
+        for (size_t c = core_begin; c < core_end; c++) {
+            size_t begin = size_t{split.cores[c].first_tile} * TILE_SIZE;
+            size_t end = std::min(n, (size_t{split.cores[c].first_tile} + split.cores[c].num_tiles) * TILE_SIZE);
+            group_begin[c] = (first + begin) / group_size;
+            auto &mine = core_partials[c];
+            mine.assign((first + end - 1) / group_size - group_begin[c] + 1, identity());
+            for (size_t tile_first = begin; tile_first < end; tile_first += TILE_SIZE) {
+                size_t count = std::min(TILE_SIZE, end - tile_first);
+                unpack_bf16(packed, tile_first, count, values.data());
+                for (size_t i = 0; i < count; i++) {
+                    size_t token = first + tile_first + i;
+                    size_t group = token / group_size;
+                    auto &partial = mine[group - group_begin[c]];
+                    partial = combine(partial, {values[i], static_cast<uint32_t>(token - group * group_size), 1});
+                }
+            }
+        }
+    });
+
+    // Cores cover the chunk in token order, so each group's partials come from a contiguous run of cores. Combine
+    // them pairwise, a tree level at a time, then fold the result into the running partial.
+    size_t first_group = first / group_size;
+    std::vector<std::vector<Partial>> by_group((first + n - 1) / group_size - first_group + 1);
+    for (size_t c = 0; c < core_partials.size(); c++) {
+        for (size_t g = 0; g < core_partials[c].size(); g++) {
+            by_group[group_begin[c] + g - first_group].push_back(core_partials[c][g]);
+        }
+    }
+    for (size_t g = 0; g < by_group.size(); g++) {
+        auto &level = by_group[g];
+        while (level.size() > 1) {
+            for (size_t i = 0; i < level.size() / 2; i++) {
+                level[i] = combine(level[2 * i], level[2 * i + 1]);
+            }
+            if (level.size() % 2 != 0) {
+                level[level.size() / 2] = level.back();
+            }
+            level.resize((level.size() + 1) / 2);
+        }
+        auto &total = partials[first_group + g];
+        total = combine(total, level.front());
+    }
+}
+
+void ReduceStream::finish(Rounding rounding) {
+    results.resize(partials.size());
+    result_indices.assign(reduce_op == ReduceOp::ArgMax ? partials.size() : 0, 0);
+    for (size_t g = 0; g < partials.size(); g++) {
+        const auto &partial = partials[g];
+        results[g] = reduce_op == ReduceOp::Mean && partial.count != 0
+                         ? partial.value / static_cast<float>(partial.count)
+                         : partial.value;
+        if (reduce_op == ReduceOp::ArgMax) {
+            result_indices[g] = partial.index;
+        }
+    }
+    pack_bf16(results.data(), results.size(), data.data(), 0, rounding);
+}
+
+void ScanStream::scan(
+    const uint32_t *packed, size_t first, size_t n, const WorkSplit &split, ThreadPool &pool, Rounding rounding) {
+    auto core_range = [&](size_t c) {
+        size_t begin = size_t{split.cores[c].first_tile} * TILE_SIZE;
+        return std::make_pair(begin, std::min(n, begin + size_t{split.cores[c].num_tiles} * TILE_SIZE));
+    };
+    // Pass 1: per-core totals.
+    std::vector<float> carries(split.cores.size());
+    pool.parallel_for(split.cores.size(), 1, [&](size_t core_begin, size_t core_end) {
+        std::array<float, TILE_SIZE> values;
+        for (size_t c = core_begin; c < core_end; c++) {
+            auto [begin, end] = core_range(c);
+            float total = 0.0F;
+            for (size_t tile_first = begin; tile_first < end; tile_first += TILE_SIZE) {
+                size_t count = std::min(TILE_SIZE, end - tile_first);
+                unpack_bf16(packed, tile_first, count, values.data());
+                for (size_t i = 0; i < count; i++) {
+                    total += values[i];
+                }
+            }
+            carries[c] = total;
+        }
+    });
+    // Carry propagation across cores (and from the previous chunk).
+    for (auto &core_carry : carries) {
+        float total = core_carry;
+        core_carry = carry;
+        carry += total;
+    }
+    // Pass 2: every core scans its own tiles from its carry.
+    auto sink = words();
+    pool.parallel_for(split.cores.size(), 1, [&](size_t core_begin, size_t core_end) {
+        std::array<float, TILE_SIZE> values;
+        for (size_t c = core_begin; c < core_end; c++) {
+            auto [begin, end] = core_range(c);
+            float running = carries[c];
+            for (size_t tile_first = begin; tile_first < end; tile_first += TILE_SIZE) {
+                size_t count = std::min(TILE_SIZE, end - tile_first);
+                unpack_bf16(packed, tile_first, count, values.data());
+                for (size_t i = 0; i < count; i++) {
+                    float value = values[i];
+                    values[i] = scan_kind == ScanKind::Inclusive ? running + value : running;
+                    running += value;
+                }
+                pack_bf16(values.data(), count, sink.data(), first + tile_first, rounding);
+            }
+        }
+    });
+}
+
+StencilStream::StencilStream(
+    const std::vector<uint32_t> &image,
+    uint32_t width,
+    uint32_t height,
+    std::vector<Offset> offsets,
+    Boundary boundary) :
+    Stream(image, width * height),
+    image_width(width),
+    image_height(height),
+    offsets(std::move(offsets)),
+    policy(boundary) {
+    if (width == 0 || height == 0 || uint64_t{width} * height > UINT32_MAX) {
+        throw std::invalid_argument("StencilStream: image must have between 1 and 2^32 - 1 pixels");
+    }
+    if (this->offsets.empty()) {
+        throw std::invalid_argument("StencilStream: stencil has no taps");
+    }
+    if (image.size() * 2 < count) {
+        throw std::invalid_argument("StencilStream: image is smaller than width * height");
+    }
+    data.resize((count + 1) / 2);
+}
+
+std::vector<StencilStream::Offset> StencilStream::box(uint32_t radius) {
+    std::vector<Offset> offsets;
+    auto r = static_cast<int32_t>(radius);
+    for (int32_t dy = -r; dy <= r; dy++) {
+        for (int32_t dx = -r; dx <= r; dx++) {
+            offsets.push_back({dx, dy});
+        }
+    }
+    return offsets;
+}
+
+std::vector<StencilStream::Offset> StencilStream::row(uint32_t radius) {
+    std::vector<Offset> offsets;
+    for (auto dx = -static_cast<int32_t>(radius); dx <= static_cast<int32_t>(radius); dx++) {
+        offsets.push_back({dx, 0});
+    }
+    return offsets;
+}
+
+std::vector<StencilStream::Offset> StencilStream::column(uint32_t radius) {
+    std::vector<Offset> offsets;
+    for (auto dy = -static_cast<int32_t>(radius); dy <= static_cast<int32_t>(radius); dy++) {
+        offsets.push_back({0, dy});
+    }
+    return offsets;
+}
+
+Stream::Stream(MappedFile &file) : count(0), mapping(file.words(), file.num_words()), mapped(true) {
+    if (file.header().format != DataFormat::Float16_b) {
+        throw std::invalid_argument("Stream: mapped file is not bf16");
+    }
+    if (file.header().count > UINT32_MAX) {
+        throw std::invalid_argument("Stream: mapped file has too many elements");
+    }
+    count = static_cast<uint32_t>(file.header().count);
+    read_only = !file.writable();
+}
+
+GatherStream::GatherStream(MappedFile &table, MappedFile &index_file, uint8_t accesses_per_token) :
+    Stream(table),
+    index_mapping(index_file.words(), index_file.num_words()),
+    accesses_per_token(accesses_per_token) {
+    if (index_file.header().format != DataFormat::UInt32) {
+        throw std::invalid_argument("GatherStream: index file is not UInt32");
+    }
+    // Indices land anywhere in the table; read-ahead would only evict the pages they do touch.
+    table.advise(Access::Random);
+    count = gather_token_count(index_mapping.size(), accesses_per_token);
+}
+
+void GatherStream::reorder(const DramGeometry &dram) {
+    if (variable_arity()) {
+        throw std::invalid_argument("GatherStream: reordering CSR gathers is not supported");
+    }
+    geometry = dram;
+    gather_plan.reset();
+    auto current = index_span();
+    gather_plan = plan_gather(std::vector<uint32_t>(current.begin(), current.end()), accesses_per_token, geometry);
+}
+
+CpuMap::CpuMap(std::vector<Kernel *> kernels, std::vector<Stream *> streams, size_t num_threads) :
+    kernels(std::move(kernels)), streams(std::move(streams)) {
+    if (num_threads == 0) {
+        pool = &ThreadPool::global();
+    } else {
+        own_pool = std::make_unique<ThreadPool>(num_threads);
+        pool = own_pool.get();
+    }
+}
+
+CpuMap::~CpuMap() = default;
+
+size_t CpuMap::input_port_index(Kernel *kernel, const std::string &port) const {
+    const auto &ports = kernel->inputs();
+    auto it = std::find(ports.begin(), ports.end(), port);
+    if (it == ports.end()) {
+        throw std::invalid_argument("CpuMap: kernel has no input port " + port);
+    }
+    return it - ports.begin();
+}
+
+size_t CpuMap::output_port_index(Kernel *kernel, const std::string &port) const {
+    const auto &ports = kernel->outputs();
+    auto it = std::find(ports.begin(), ports.end(), port);
+    if (it == ports.end()) {
+        throw std::invalid_argument("CpuMap: kernel has no output port " + port);
+    }
+    return it - ports.begin();
+}
+
+void CpuMap::add_connection(Stream *src, Kernel *dst, const std::string &dst_port) {
+    compiled.reset();
+    connections.push_back({{src, nullptr, 0}, {nullptr, dst, input_port_index(dst, dst_port)}});
+}
+
+void CpuMap::add_connection(Kernel *src, const std::string &src_port, Kernel *dst, const std::string &dst_port) {
+    compiled.reset();
+    connections.push_back(
+        {{nullptr, src, output_port_index(src, src_port)}, {nullptr, dst, input_port_index(dst, dst_port)}});
+}
+
+void CpuMap::add_connection(Kernel *src, const std::string &src_port, Stream *dst) {
+    compiled.reset();
+    connections.push_back({{nullptr, src, output_port_index(src, src_port)}, {dst, nullptr, 0}});
+}
+
+std::vector<Kernel *> CpuMap::topological_order() const {
+    std::map<Kernel *, size_t> pending;
+    for (auto *kernel : kernels) {
+        pending[kernel] = 0;
+    }
+    for (const auto &c : connections) {
+        if (c.src.kernel != nullptr && c.dst.kernel != nullptr) {
+            pending[c.dst.kernel]++;
+        }
+    }
+    std::vector<Kernel *> order;
+    std::vector<Kernel *> ready;
+    for (auto *kernel : kernels) {
+        if (pending[kernel] == 0) {
+            ready.push_back(kernel);
+        }
+    }
+    while (!ready.empty()) {
+        auto *kernel = ready.back();
+        ready.pop_back();
+        order.push_back(kernel);
+        for (const auto &c : connections) {
+            if (c.src.kernel == kernel && c.dst.kernel != nullptr && --pending[c.dst.kernel] == 0) {
+                ready.push_back(c.dst.kernel);
+            }
+        }
+    }
+    if (order.size() != kernels.size()) {
+        throw std::runtime_error("CpuMap: kernel graph has a cycle");
+    }
+    return order;
+}
+
+std::vector<CpuMap::CompiledStage> CpuMap::build_stages() const {
+    std::vector<CompiledStage> stages;
+    for (auto *kernel : topological_order()) {
+        CompiledStage stage;
+        stage.kernels = {kernel};
+        // Inputs are addressable by port name, or positionally as in0, in1, ... (gathered accesses).
+        std::vector<std::string> slot_names;
+        for (size_t port = 0; port < kernel->inputs().size(); port++) {
+            auto it = std::find_if(connections.begin(), connections.end(), [&](const Connection &c) {
+                return c.dst.kernel == kernel && c.dst.port == port;
+            });
+            if (it == connections.end()) {
+                throw std::runtime_error("CpuMap: input port " + kernel->inputs()[port] + " is not connected");
+            }
+            auto *gather = dynamic_cast<GatherStream *>(it->src.stream);
+            auto *stencil = dynamic_cast<StencilStream *>(it->src.stream);
+            if (stencil != nullptr && stencil->taps() > 1) {
+                for (uint32_t j = 0; j < stencil->taps(); j++) {
+                    stage.inputs.push_back({.stream = stencil, .access = j});
+                    slot_names.emplace_back();
+                }
+            } else if (gather != nullptr && (gather->accesses() > 1 || gather->variable_arity())) {
+                for (uint32_t j = 0; j < gather->max_arity(); j++) {
+                    stage.inputs.push_back({.stream = gather, .access = j});
+                    slot_names.emplace_back();
+                }
+                if (gather->variable_arity()) {
+                    stage.inputs.push_back({.stream = gather, .access = COUNT_ACCESS});
+                    slot_names.emplace_back("count");
+                }
+            } else {
+                stage.inputs.push_back({.stream = it->src.stream, .kernel = it->src.kernel, .port = it->src.port});
+                slot_names.push_back(kernel->inputs()[port]);
+            }
+        }
+        stage.program = expr::compile(kernel->compute(), slot_names, kernel->outputs());
+        stages.push_back(std::move(stage));
+    }
+    if (!fusion) {
+        return stages;
+    }
+
+    auto consumers = [&](Kernel *kernel, size_t port) {
+        return std::count_if(connections.begin(), connections.end(), [&](const Connection &c) {
+            return c.src.kernel == kernel && c.src.port == port;
+        });
+    };
+    // Stages are in topological order, so every producer precedes its consumer.
+    for (size_t b = 0; b < stages.size(); b++) {
+        bool fused = true;
+        while (fused) {
+            fused = false;
+            for (uint32_t slot = 0; slot < stages[b].inputs.size() && !fused; slot++) {
+                const auto input = stages[b].inputs[slot];
+                if (input.kernel == nullptr || input.kernel->outputs().size() != 1 ||
+                    consumers(input.kernel, input.port) != 1) {
+                    continue;
+                }
+                auto a = static_cast<size_t>(
+                    std::find_if(
+                        stages.begin(),
+                        stages.begin() + b,
+                        [&](const CompiledStage &stage) { return stage.kernels.back() == input.kernel; }) -
+                    stages.begin());
+                auto &producer = stages[a];
+                auto &consumer = stages[b];
+                consumer.program = expr::fuse(producer.program, 0, consumer.program, slot);
+                auto inputs = producer.inputs;
+                for (uint32_t i = 0; i < consumer.inputs.size(); i++) {
+                    if (i != slot) {
+                        inputs.push_back(consumer.inputs[i]);
+                    }
+                }
+                consumer.inputs = std::move(inputs);
+                consumer.kernels.insert(consumer.kernels.begin(), producer.kernels.begin(), producer.kernels.end());
+                stages.erase(stages.begin() + a);
+                b--;
+                fused = true;
+            }
+        }
+    }
+    return stages;
+}
+
+CacheKey CpuMap::cache_key() const {
+    auto stream_index = [&](Stream *stream) {
+        return stream == nullptr ? UINT64_MAX : std::find(streams.begin(), streams.end(), stream) - streams.begin();
+    };
+    auto kernel_index = [&](Kernel *kernel) {
+        return kernel == nullptr ? UINT64_MAX : std::find(kernels.begin(), kernels.end(), kernel) - kernels.begin();
+    };
+
+    CacheKey key;
+    key.add("CpuMap stages v1").add(fusion ? 1 : 0);
+    for (auto *kernel : kernels) {
+        key.add(kernel->inputs().size()).add(kernel->outputs().size());
+        for (const auto &port : kernel->inputs()) {
+            key.add(port);
+        }
+        for (const auto &port : kernel->outputs()) {
+            key.add(port);
+        }
+        key.add(kernel->compute());
+    }
+    for (auto *stream : streams) {
+        auto *gather = dynamic_cast<GatherStream *>(stream);
+        auto *stencil = dynamic_cast<StencilStream *>(stream);
+        key.add("Float16_b").add(gather != nullptr ? gather->max_arity() : stencil != nullptr ? stencil->taps() : 0);
+        key.add(gather != nullptr && gather->variable_arity() ? 1 : 0);
+    }
+    for (const auto &c : connections) {
+        key.add(stream_index(c.src.stream)).add(kernel_index(c.src.kernel)).add(c.src.port);
+        key.add(stream_index(c.dst.stream)).add(kernel_index(c.dst.kernel)).add(c.dst.port);
+    }
+    return key;
+}
+
+// Entry layout: "stages" lists, per stage, its kernels and input sources by index; stage<i>.ir holds the program and
+// stage<i>_compute.cpp the generated compute loop, left out when the program does not fit the dest registers (the host
+// runs it regardless, and decode() only needs the IR).
+CacheEntry CpuMap::encode(const std::vector<CompiledStage> &stages) const {
+    auto index = [](const auto &items, auto *item) {
+        return std::find(items.begin(), items.end(), item) - items.begin();
+    };
+    CacheEntry entry;
+    std::ostringstream plan;
+    plan << stages.size() << "\n";
+    for (size_t i = 0; i < stages.size(); i++) {
+        const auto &stage = stages[i];
+        plan << stage.kernels.size();
+        for (auto *kernel : stage.kernels) {
+            plan << " " << index(kernels, kernel);
+        }
+        plan << "\n" << stage.inputs.size();
+        for (const auto &input : stage.inputs) {
+            if (input.kernel != nullptr) {
+                plan << " k " << index(kernels, input.kernel) << " " << input.port;
+            } else {
+                plan << " s " << index(streams, input.stream) << " " << input.access;
+            }
+        }
+        plan << "\n";
+        entry.files["stage" + std::to_string(i) + ".ir"] = expr::serialize(stage.program);
+        try {
+            entry.files["stage" + std::to_string(i) + "_compute.cpp"] = expr::schedule(stage.program).render();
+        } catch (const std::runtime_error &) {
+            // Too many live values for the device; the IR alone is enough to run it here.
+        }
+    }
+    entry.files["stages"] = plan.str();
+    return entry;
+}
+
+std::vector<CpuMap::CompiledStage> CpuMap::decode(const CacheEntry &entry) const {
+    auto fail = [] { throw std::invalid_argument("CpuMap: corrupt kernel cache entry"); };
+    auto file = [&](const std::string &name) -> const std::string & {
+        auto it = entry.files.find(name);
+        if (it == entry.files.end()) {
+            fail();
+        }
+        return it->second;
+    };
+    std::istringstream plan(file("stages"));
+    size_t num_stages = 0;
+    if (!(plan >> num_stages)) {
+        fail();
+    }
+    std::vector<CompiledStage> stages(num_stages);
+    for (size_t i = 0; i < num_stages; i++) {
+        auto &stage = stages[i];
+        size_t n = 0;
+        plan >> n;
+        for (size_t j = 0; j < n; j++) {
+            size_t k = SIZE_MAX;
+            if (!(plan >> k) || k >= kernels.size()) {
+                fail();
+            }
+            stage.kernels.push_back(kernels[k]);
+        }
+        plan >> n;
+        for (size_t j = 0; j < n; j++) {
+            std::string kind;
+            size_t idx = SIZE_MAX;
+            unsigned port = 0;
+            if (!(plan >> kind >> idx >> port)) {
+                fail();
+            }
+            if (kind == "k" && idx < kernels.size()) {
+                stage.inputs.push_back({.kernel = kernels[idx], .port = port});
+            } else if (kind == "s" && idx < streams.size()) {
+                stage.inputs.push_back({.stream = streams[idx], .access = port});
+            } else {
+                fail();
+            }
+        }
+        stage.program = expr::deserialize(file("stage" + std::to_string(i) + ".ir"));
+        if (stage.kernels.empty() || stage.program.live_inputs.size() != stage.inputs.size()) {
+            fail();
+        }
+    }
+    return stages;
+}
+
+std::vector<CpuMap::CompiledStage> CpuMap::compile_stages() const {
+    if (cache == nullptr) {
+        return build_stages();
+    }
+    auto key = cache_key();
+    if (auto entry = cache->lookup(key)) {
+        try {
+            return decode(*entry);
+        } catch (const std::invalid_argument &) {
+            // Fall through and overwrite the damaged entry.
+        }
+    }
+    auto stages = build_stages();
+    cache->store(key, encode(stages));
+    return stages;
+}
+
+const std::vector<CpuMap::CompiledStage> &CpuMap::compiled_stages() const {
+    if (!compiled) {
+        compiled = compile_stages();
+    }
+    return *compiled;
+}
+
+std::vector<CpuMap::Stage> CpuMap::plan() const {
+    std::vector<Stage> plan;
+    for (const auto &stage : compiled_stages()) {
+        plan.push_back({stage.kernels, expr::schedule(stage.program).counts()});
+    }
+    return plan;
+}
+
+uint64_t CpuMap::traffic_bytes(Stream *stream) {
+    if (auto *gather = dynamic_cast<GatherStream *>(stream)) {
+        return (gather->words().size() + gather->index_span().size() + gather->csr_offsets.size()) * sizeof(uint32_t);
+    }
+    if (auto *scatter = dynamic_cast<ScatterStream *>(stream)) {
+        // The table goes in and comes back out.
+        return (2 * scatter->data.size() + scatter->indices.size()) * sizeof(uint32_t);
+    }
+    if (dynamic_cast<StencilStream *>(stream) != nullptr) {
+        return stream->words().size() * sizeof(uint32_t);
+    }
+    return (uint64_t{stream->size()} + 1) / 2 * sizeof(uint32_t);
+}
+
+ExecutionStats CpuMap::execute() {
+    using Clock = std::chrono::steady_clock;
+    ExecutionStats stats;
+    auto start = Clock::now();
+    auto since = [](Clock::time_point from) { return Clock::now() - from; };
+
+    if (!compiled) {
+        compiled = compile_stages();
+        stats.generation = since(start);
+    }
+    auto phase = Clock::now();
+
+    // Gather tables and stencil images are widened once up front (and again only after a rebind); every token then
+    // reads fp32 directly. Mapped ones are read as bf16 from the mapping instead: a widened copy would take twice the
+    // file's size in memory, which is what mapping them avoids.
+    for (auto *stream : streams) {
+        bool resident =
+            dynamic_cast<GatherStream *>(stream) != nullptr || dynamic_cast<StencilStream *>(stream) != nullptr;
+        if (resident && !stream->mapped && !tables.contains(stream)) {
+            auto &table = tables[stream];
+            auto words = stream->words();
+            table.resize(words.size() * 2);
+            pool->parallel_for(words.size(), TILE_SIZE, [&](size_t begin, size_t end) {
+                unpack_bf16(words.data(), begin * 2, (end - begin) * 2, table.data() + begin * 2);
+            });
+        }
+    }
+
+    stats.host_to_device += since(phase);
+    phase = Clock::now();
+
+    // Token count of every stage and kernel output.
+    std::vector<uint32_t> stage_counts;
+    std::map<std::pair<Kernel *, size_t>, uint32_t> result_counts;
+    std::vector<Stream *> staged;  // Source streams read by some stage.
+    for (const auto &stage : *compiled) {
+        uint32_t count = UINT32_MAX;
+        for (const auto &input : stage.inputs) {
+            if (input.kernel != nullptr) {
+                count = std::min(count, result_counts.at({input.kernel, input.port}));
+                continue;
+            }
+            count = std::min(count, input.stream->size());
+            // A stencil's image is resident like a gather table, and it has no index buffer to stream.
+            if (dynamic_cast<StencilStream *>(input.stream) == nullptr &&
+                std::find(staged.begin(), staged.end(), input.stream) == staged.end()) {
+                staged.push_back(input.stream);
+            }
+        }
+        stage_counts.push_back(count);
+        for (size_t port = 0; port < stage.kernels.back()->outputs().size(); port++) {
+            result_counts[{stage.kernels.back(), port}] = count;
+        }
+    }
+    uint32_t total = stage_counts.empty() ? 0 : *std::max_element(stage_counts.begin(), stage_counts.end());
+    size_t total_tiles = (total + TILE_SIZE - 1) / TILE_SIZE;
+    size_t chunk_size = (chunk_tiles != 0 ? size_t{chunk_tiles} : total_tiles) * TILE_SIZE;
+    size_t num_chunks = chunk_size == 0 ? 0 : (total + chunk_size - 1) / chunk_size;
+    stats.validation = since(phase);
+    phase = Clock::now();
+
+    std::vector<ScatterStream *> scatters;
+    std::vector<ReduceStream *> reduces;
+    for (const auto &c : connections) {
+        auto *sink = c.dst.stream;
+        if (sink == nullptr) {
+            continue;
+        }
+        if (auto *scatter = dynamic_cast<ScatterStream *>(sink)) {
+            // Accumulate in fp32 for the whole execution; the table is rounded and written back once at the end.
+            auto &table = tables[scatter];
+            table.resize(scatter->table_size());
+            unpack_bf16(scatter->data.data(), 0, table.size(), table.data());
+            scatters.push_back(scatter);
+            continue;
+        }
+        if (auto *reduce = dynamic_cast<ReduceStream *>(sink)) {
+            reduce->partials.assign(reduce->partials.size(), reduce->identity());
+            reduces.push_back(reduce);
+            continue;
+        }
+        if (auto *scan = dynamic_cast<ScanStream *>(sink)) {
+            scan->carry = 0.0F;
+        }
+        if (sink->mapped && sink->read_only) {
+            throw std::runtime_error("CpuMap: sink is mapped read-only");
+        }
+        if (!sink->mapped && sink->data.size() < (sink->size() + 1) / 2) {
+            sink->data.resize((sink->size() + 1) / 2);
+        }
+    }
+
+    // Unchunked, an output whose only consumer is a plain sink that can hold it is written straight into the sink
+    // instead of a full-size buffer copied over afterwards. The sink must not also be read by a stage.
+    std::map<std::pair<Kernel *, size_t>, Stream *> direct;
+    if (chunk_tiles == 0) {
+        for (const auto &c : connections) {
+            auto *sink = c.dst.stream;
+            if (sink == nullptr || dynamic_cast<ScatterStream *>(sink) != nullptr ||
+                dynamic_cast<ReduceStream *>(sink) != nullptr || dynamic_cast<ScanStream *>(sink) != nullptr ||
+                result_counts.at({c.src.kernel, c.src.port}) > sink->size()) {
+                continue;
+            }
+            auto consumers = std::count_if(connections.begin(), connections.end(), [&](const Connection &other) {
+                return other.src.kernel == c.src.kernel && other.src.port == c.src.port;
+            });
+            bool read_by_stage = std::any_of(connections.begin(), connections.end(), [&](const Connection &other) {
+                return other.src.stream == sink;
+            });
+            if (consumers == 1 && !read_by_stage) {
+                direct[{c.src.kernel, c.src.port}] = sink;
+            }
+        }
+    }
+
+    stats.allocation = since(phase);
+
+    // Host -> device: copy this chunk of every source stream (packed data, or indices for a gather) into the slot.
+    // Unchunked, the whole stream already is the one chunk and stages read it in place.
+    auto write = [&](size_t chunk, size_t slot) {
+        if (chunk_tiles == 0) {
+            return;
+        }
+        auto begin = Clock::now();
+        size_t first = chunk * chunk_size;
+        for (auto *stream : staged) {
+            size_t n = std::min<size_t>(chunk_size, stream->size() > first ? stream->size() - first : 0);
+            auto &buffer = slots[slot].inputs[stream];
+            auto *gather = dynamic_cast<GatherStream *>(stream);
+            if (gather != nullptr && gather->variable_arity()) {
+                auto &offsets = slots[slot].csr_offsets[gather];
+                offsets.resize(chunk_size + 1);
+                size_t base = std::min<size_t>(first, gather->size());
+                std::copy_n(gather->csr_offsets.begin() + base, n + 1, offsets.begin());
+                buffer.resize(offsets[n] - offsets[0]);
+                std::copy_n(gather->index_span().begin() + offsets[0], buffer.size(), buffer.begin());
+            } else if (gather != nullptr) {
+                buffer.resize(chunk_size * gather->accesses());
+                size_t stride = gather->accesses();
+                std::copy_n(gather->index_span().begin() + first * stride, n * stride, buffer.begin());
+                if (gather->gather_plan) {
+                    auto &offsets = slots[slot].read_offsets[gather];
+                    offsets.resize(chunk_size * stride);
+                    const auto &read_offsets = gather->gather_plan->read_offsets;
+                    std::copy_n(read_offsets.begin() + first * stride, n * stride, offsets.begin());
+                }
+            } else {
+                buffer.resize(chunk_size / 2);
+                std::copy_n(stream->words().begin() + first / 2, (n + 1) / 2, buffer.begin());
+            }
+        }
+        stats.host_to_device += since(begin);
+    };
+
+    // Widened copy of a gather table or stencil image, or null for a mapped one.
+    auto resident_table = [&](Stream *stream) -> const float * {
+        return stream->mapped ? nullptr : tables.at(stream).data();
+    };
+
+    auto run = [&](size_t chunk, size_t slot) {
+        auto begin = Clock::now();
+        size_t first = chunk * chunk_size;
+        auto &buffers = slots[slot];
+        for (size_t s = 0; s < compiled->size(); s++) {
+            const auto &stage = (*compiled)[s];
+            const auto &program = stage.program;
+            size_t count = std::min<size_t>(chunk_size, stage_counts[s] > first ? stage_counts[s] - first : 0);
+
+            std::vector<ValueSource> values;
+            for (const auto &input : stage.inputs) {
+                if (input.kernel != nullptr) {
+                    values.push_back({.packed = buffers.outputs.at({input.kernel, input.port}).data()});
+                } else if (auto *stencil = dynamic_cast<StencilStream *>(input.stream)) {
+                    values.push_back(
+                        {.table = resident_table(stencil),
+                         .packed_table = stencil->words().data(),
+                         .table_size = stencil->words().size() * 2,
+                         .access = input.access,
+                         .stencil = stencil,
+                         .token_base = first});
+                } else if (auto *gather = dynamic_cast<GatherStream *>(input.stream)) {
+                    const uint32_t *read_offsets = nullptr;
+                    if (gather->gather_plan) {
+                        read_offsets = chunk_tiles != 0
+                                           ? buffers.read_offsets.at(gather).data()
+                                           : gather->gather_plan->read_offsets.data() + first * gather->accesses();
+                    }
+                    const uint32_t *csr_offsets = nullptr;
+                    size_t index_first = first * gather->accesses();
+                    if (gather->variable_arity() && chunk_tiles != 0) {
+                        csr_offsets = buffers.csr_offsets.at(gather).data();
+                    } else if (gather->variable_arity()) {
+                        // Unchunked there is one chunk, so first is 0 and within the offsets.
+                        csr_offsets = gather->csr_offsets.data() + first;
+                        index_first = gather->csr_offsets[first];
+                    }
+                    values.push_back(
+                        {.table = resident_table(gather),
+                         .packed_table = gather->words().data(),
+                         .indices = chunk_tiles != 0 ? buffers.inputs.at(gather).data()
+                                                     : gather->index_span().data() + index_first,
+                         .table_size = gather->words().size() * 2,
+                         .stride = gather->accesses(),
+                         .access = input.access,
+                         .csr_offsets = csr_offsets,
+                         .read_offsets = read_offsets,
+                         .tokens = gather->size() - std::min<size_t>(first, gather->size())});
+                } else {
+                    values.push_back(
+                        {.packed = chunk_tiles != 0 ? buffers.inputs.at(input.stream).data()
+                                                    : input.stream->words().data() + first / 2});
+                }
+            }
+
+            // Output buffers persist across chunks and executions; only their contents change.
+            auto *last = stage.kernels.back();
+            std::vector<uint32_t *> outputs;
+            for (size_t port = 0; port < last->outputs().size(); port++) {
+                if (auto it = direct.find({last, port}); it != direct.end()) {
+                    outputs.push_back(it->second->words().data() + first / 2);
+                    continue;
+                }
+                auto &buffer = buffers.outputs[{last, port}];
+                buffer.resize(chunk_size / 2);
+                outputs.push_back(buffer.data());
+            }
+
+            auto n_tiles = static_cast<uint32_t>((count + TILE_SIZE - 1) / TILE_SIZE);
+            auto split = split_work(n_tiles, parallelization, core_grid);
+            pool->parallel_for(split.cores.size(), 1, [&](size_t core_begin, size_t core_end) {
+                TileEvaluator eval(program.nodes.size());
+                size_t tile_begin = split.cores[core_begin].first_tile;
+                size_t tile_end = split.cores[core_end - 1].first_tile + split.cores[core_end - 1].num_tiles;
+                for (size_t tile = tile_begin; tile < tile_end; tile++) {
+                    size_t tile_first = tile * TILE_SIZE;
+                    size_t n = std::min<size_t>(TILE_SIZE, count - tile_first);
+                    for (size_t id = 0; id < program.nodes.size(); id++) {
+                        const auto &node = program.nodes[id];
+                        float *out = eval.values[id].data();
+                        switch (node.op) {
+                            case expr::Op::Input: eval.load(values[node.input], tile_first, n, out); break;
+                            case expr::Op::Constant: std::fill_n(out, n, node.value); break;
+                            default:
+                                apply(node.op, eval.values[node.lhs].data(), eval.values[node.rhs].data(), out, n);
+                                round_to_bf16(out, n, rounding);
+                                break;
+                        }
+                    }
+                    for (size_t port = 0; port < outputs.size(); port++) {
+                        pack_bf16(eval.values[program.outputs[port]].data(), n, outputs[port], tile_first, rounding);
+                    }
+                }
+            });
+            if (chunk == 0) {
+                splits.push_back(std::move(split));
+            }
+        }
+        stats.device += since(begin);
+    };
+
+    // Device -> host: copy this chunk of every sink's producer into the sink.
+    auto read = [&](size_t chunk, size_t slot) {
+        auto begin = Clock::now();
+        size_t first = chunk * chunk_size;
+        for (const auto &c : connections) {
+            if (c.dst.stream == nullptr || direct.contains({c.src.kernel, c.src.port})) {
+                continue;
+            }
+            uint32_t count = std::min(c.dst.stream->size(), result_counts.at({c.src.kernel, c.src.port}));
+            size_t n = std::min<size_t>(chunk_size, count > first ? count - first : 0);
+            const auto &result = slots[slot].outputs.at({c.src.kernel, c.src.port});
+            if (auto *scatter = dynamic_cast<ScatterStream *>(c.dst.stream)) {
+                // Chunks arrive in order and are combined in token order, so duplicates resolve deterministically.
+                auto &table = tables.at(scatter);
+                const uint32_t *indices = scatter->indices.data() + first;
+                for (size_t i = 0; i < n; i++) {
+                    float value = bf16_to_float(packed_bf16_at(result.data(), i));
+                    float &dst = table[indices[i]];
+                    switch (scatter->op()) {
+                        case ScatterOp::Overwrite: dst = value; break;
+                        case ScatterOp::Add: dst += value; break;
+                        case ScatterOp::Max: dst = std::max(dst, value); break;
+                        case ScatterOp::Min: dst = std::min(dst, value); break;
+                    }
+                }
+                continue;
+            }
+            if (auto *reduce = dynamic_cast<ReduceStream *>(c.dst.stream)) {
+                auto n_tiles = static_cast<uint32_t>((n + TILE_SIZE - 1) / TILE_SIZE);
+                reduce->accumulate(result.data(), first, n, split_work(n_tiles, parallelization, core_grid), *pool);
+                continue;
+            }
+            if (auto *scan = dynamic_cast<ScanStream *>(c.dst.stream)) {
+                auto n_tiles = static_cast<uint32_t>((n + TILE_SIZE - 1) / TILE_SIZE);
+                scan->scan(result.data(), first, n, split_work(n_tiles, parallelization, core_grid), *pool, rounding);
+                continue;
+            }
+            auto *sink = c.dst.stream->words().data() + first / 2;
+            std::copy_n(result.begin(), n / 2, sink);
+            if (n % 2 != 0) {
+                // Odd tail: the high half of the last word is past the end of the stream, keep what the sink had.
+                sink[n / 2] = (sink[n / 2] & 0xFFFF0000U) | (result[n / 2] & 0xFFFFU);
+            }
+        }
+        stats.readback += since(begin);
+    };
+
+    splits.clear();
+    run_double_buffered(num_chunks, {write, run, read});
+    phase = Clock::now();
+    for (auto *scatter : scatters) {
+        const auto &table = tables.at(scatter);
+        pack_bf16(table.data(), table.size(), scatter->data.data(), 0, rounding);
+        tables.erase(scatter);
+    }
+    for (auto *reduce : reduces) {
+        reduce->finish(rounding);
+    }
+    stats.readback += since(phase);
+
+    stats.total = since(start);
+    for (auto *stream : streams) {
+        uint64_t bytes = traffic_bytes(stream);
+        stats.streams.push_back({stream, bytes, gbps(bytes, stats.total)});
+    }
+    return stats;
+}
+
+Traffic CpuMap::traffic(const DramGeometry &dram, uint32_t l1_budget) const {
+    const auto &stages = compiled_stages();
+    Traffic traffic;
+    traffic.dram_bank_bytes.assign(dram.num_banks, 0);
+    std::map<std::pair<uint32_t, uint32_t>, size_t> core_index;
+    auto core_load = [&](const CoreWork &work) -> CoreLoad & {
+        auto [it, inserted] = core_index.try_emplace({work.x, work.y}, traffic.cores.size());
+        if (inserted) {
+            CoreLoad load;
+            load.x = work.x;
+            load.y = work.y;
+            traffic.cores.push_back(load);
+        }
+        return traffic.cores[it->second];
+    };
+    // Bytes [first, first + n) of an interleaved buffer, page by page.
+    auto stream_bytes = [&](uint64_t first, uint64_t n, CoreLoad &core) {
+        core.noc_bytes += n;
+        while (n > 0) {
+            uint64_t page = first / dram.page_size;
+            uint64_t in_page = std::min<uint64_t>(n, (page + 1) * dram.page_size - first);
+            traffic.dram_bank_bytes[page % dram.num_banks] += in_page;
+            first += in_page;
+            n -= in_page;
+        }
+    };
+    // One chunk of a packed table in DRAM.
+    auto chunk_bytes = [&](uint64_t chunk, CoreLoad &core) {
+        core.noc_bytes += dram.chunk_size;
+        traffic.dram_bank_bytes[chunk * dram.chunk_size / dram.page_size % dram.num_banks] += dram.chunk_size;
+    };
+    // A resident table (gather table, stencil image) read by `core`: copied once if it fits L1, else a chunk per
+    // element index, skipping repeats of the previous chunk.
+    auto table_reads = [&](uint64_t table_elements, const auto &for_each_index, CoreLoad &core) {
+        uint64_t table_bytes = dram.packed_bytes(table_elements);
+        if (table_bytes <= l1_budget) {
+            stream_bytes(0, table_bytes, core);
+            for_each_index([&](uint32_t) { core.accesses++; });
+            return;
+        }
+        uint64_t cached = UINT64_MAX;
+        for_each_index([&](uint32_t index) {
+            core.accesses++;
+            if (dram.chunk_of(index) != cached) {
+                cached = dram.chunk_of(index);
+                chunk_bytes(cached, core);
+            }
+        });
+    };
+
+    std::map<std::pair<Kernel *, size_t>, uint32_t> result_counts;
+    for (const auto &stage : stages) {
+        uint32_t count = UINT32_MAX;
+        for (const auto &input : stage.inputs) {
+            count = std::min(
+                count, input.kernel != nullptr ? result_counts.at({input.kernel, input.port}) : input.stream->size());
+        }
+        count = count == UINT32_MAX ? 0 : count;
+        auto *last = stage.kernels.back();
+        for (size_t port = 0; port < last->outputs().size(); port++) {
+            result_counts[{last, port}] = count;
+        }
+
+        auto ops = expr::schedule(stage.program).counts();
+        auto n_tiles = static_cast<uint32_t>((count + TILE_SIZE - 1) / TILE_SIZE);
+        for (const auto &work : split_work(n_tiles, parallelization, core_grid).cores) {
+            auto &core = core_load(work);
+            uint64_t first = uint64_t{work.first_tile} * TILE_SIZE;
+            uint64_t n = std::min<uint64_t>(uint64_t{work.num_tiles} * TILE_SIZE, count - first);
+            core.tile_ops.copies += ops.copies * work.num_tiles;
+            core.tile_ops.fpu += ops.fpu * work.num_tiles;
+            core.tile_ops.sfpu += ops.sfpu * work.num_tiles;
+            core.tile_ops.packs += ops.packs * work.num_tiles;
+
+            // A gather feeds one input per access, but its indices and table are read once.
+            std::vector<const void *> seen;
+            for (const auto &input : stage.inputs) {
+                const void *source = input.kernel != nullptr ? static_cast<const void *>(input.kernel) : input.stream;
+                if (std::find(seen.begin(), seen.end(), source) != seen.end()) {
+                    continue;
+                }
+                seen.push_back(source);
+                if (input.kernel != nullptr) {
+                    stream_bytes(first * 2, n * 2, core);
+                } else if (auto *gather = dynamic_cast<GatherStream *>(input.stream)) {
+                    auto indices = gather->index_span();
+                    uint64_t begin = first * gather->accesses();
+                    uint64_t end = (first + n) * gather->accesses();
+                    if (gather->variable_arity()) {
+                        stream_bytes(first * 4, (n + 1) * 4, core);
+                        begin = gather->csr_offsets[first];
+                        end = gather->csr_offsets[first + n];
+                    }
+                    stream_bytes(begin * 4, (end - begin) * 4, core);
+                    auto each = [&](const auto &fn) {
+                        for (uint64_t i = begin; i < end; i++) {
+                            fn(indices[i]);
+                        }
+                    };
+                    uint64_t table_words = gather->mapped ? gather->mapping.size() : gather->data.size();
+                    table_reads(table_words * 2, each, core);
+                } else if (auto *stencil = dynamic_cast<StencilStream *>(input.stream)) {
+                    auto each = [&](const auto &fn) {
+                        for (uint64_t t = first; t < first + n; t++) {
+                            for (uint32_t tap = 0; tap < stencil->taps(); tap++) {
+                                int64_t index = stencil->neighbor(static_cast<uint32_t>(t), tap);
+                                if (index >= 0) {
+                                    fn(static_cast<uint32_t>(index));
+                                }
+                            }
+                        }
+                    };
+                    table_reads(uint64_t{stencil->width()} * stencil->height(), each, core);
+                } else {
+                    stream_bytes(first * 2, n * 2, core);
+                }
+            }
+
+            for (size_t port = 0; port < last->outputs().size(); port++) {
+                bool intermediate = false;
+                for (const auto &c : connections) {
+                    if (c.src.kernel != last || c.src.port != port) {
+                        continue;
+                    }
+                    if (c.dst.kernel != nullptr) {
+                        intermediate = true;
+                        continue;
+                    }
+                    auto *sink = c.dst.stream;
+                    uint64_t sink_n = std::min<uint64_t>(n, sink->size() > first ? sink->size() - first : 0);
+                    if (auto *scatter = dynamic_cast<ScatterStream *>(sink)) {
+                        stream_bytes(first * 4, sink_n * 4, core);
+                        for (uint64_t t = first; t < first + sink_n; t++) {
+                            // Read-modify-write of the chunk holding the element.
+                            chunk_bytes(dram.chunk_of(scatter->indices[t]), core);
+                            chunk_bytes(dram.chunk_of(scatter->indices[t]), core);
+                            core.accesses++;
+                        }
+                    } else if (dynamic_cast<ReduceStream *>(sink) == nullptr) {
+                        stream_bytes(first * 2, sink_n * 2, core);
+                    }
+                }
+                // An unfused intermediate is written once, however many kernels read it.
+                if (intermediate) {
+                    stream_bytes(first * 2, n * 2, core);
+                }
+            }
+        }
+    }
+    return traffic;
+}
+
+void CpuMap::rebind(Stream *stream, const std::vector<uint32_t> &data) {
+    if (dynamic_cast<GatherStream *>(stream) != nullptr) {
+        throw std::invalid_argument("CpuMap: rebind a GatherStream with its table and index vector");
+    }
+    if (auto *scatter = dynamic_cast<ScatterStream *>(stream)) {
+        if (data.size() < scatter->data.size()) {
+            throw std::invalid_argument("CpuMap: rebound table is smaller than the scatter table");
+        }
+        scatter->data.assign(data.begin(), data.begin() + static_cast<std::ptrdiff_t>(scatter->data.size()));
+        return;
+    }
+    if (data.size() * 2 < stream->size()) {
+        throw std::invalid_argument("CpuMap: rebound data is smaller than the stream");
+    }
+    stream->data = data;
+    stream->mapped = false;
+    tables.erase(stream);
+}
+
+void CpuMap::rebind(GatherStream *stream, const std::vector<uint32_t> &table, const std::vector<uint32_t> &index_vec) {
+    if (index_vec.size() != stream->index_span().size()) {
+        throw std::invalid_argument("CpuMap: rebound index vector changes the number of tokens");
+    }
+    auto words = stream->words().size();
+    if (table.size() < words) {
+        throw std::invalid_argument("CpuMap: rebound table is smaller than the gather table");
+    }
+    stream->data.assign(table.begin(), table.begin() + static_cast<std::ptrdiff_t>(words));
+    stream->indices = index_vec;
+    stream->mapped = false;
+    if (stream->gather_plan) {
+        stream->reorder(stream->geometry);
+    }
+    tables.erase(stream);
+}
+
+size_t CpuMap::buffer_bytes() const {
+    size_t bytes = 0;
+    for (const auto &slot : slots) {
+        for (const auto &[stream, buffer] : slot.inputs) {
+            bytes += buffer.capacity() * sizeof(uint32_t);
+        }
+        for (const auto &[port, buffer] : slot.outputs) {
+            bytes += buffer.capacity() * sizeof(uint32_t);
+        }
+        for (const auto &[stream, buffer] : slot.read_offsets) {
+            bytes += buffer.capacity() * sizeof(uint32_t);
+        }
+        for (const auto &[stream, buffer] : slot.csr_offsets) {
+            bytes += buffer.capacity() * sizeof(uint32_t);
+        }
+    }
+    return bytes;
+}
+
+std::vector<uint32_t> CpuMap::read_stream(Stream *stream) const {
+    auto words = stream->words();
+    return {words.begin(), words.end()};
+}
+
+}  // namespace current::host
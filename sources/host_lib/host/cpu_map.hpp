@@ -0,0 +1,429 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "bf16.hpp"
+#include "execution_stats.hpp"
+#include "expr.hpp"
+#include "gather_plan.hpp"
+#include "kernel_cache.hpp"
+#include "mapped_file.hpp"
+#include "roofline.hpp"
+#include "scan.hpp"
+#include "table_shard.hpp"
+#include "thread_pool.hpp"
+#include "work_split.hpp"
+
+namespace current::host {
+
+// Host mirrors of current::Kernel / Stream / GatherStream. They describe the same graph as a current::Map, so a test
+// can build the pipeline once against the device and once against CpuMap and compare the results. Only bf16 data is
+// supported.
+
+class Kernel {
+   public:
+    void add_input_port(const std::string &name) { input_ports.push_back(name); }
+    void add_output_port(const std::string &name) { output_ports.push_back(name); }
+    // Same expression language as current::Kernel::set_compute_kernel. With no compute kernel every output is in0.
+    void set_compute_kernel(const std::string &code) { compute_kernel = code; }
+
+    const std::vector<std::string> &inputs() const { return input_ports; }
+    const std::vector<std::string> &outputs() const { return output_ports; }
+    const std::string &compute() const { return compute_kernel; }
+
+   private:
+    std::vector<std::string> input_ports;
+    std::vector<std::string> output_ports;
+    std::string compute_kernel;
+};
+
+class Stream {
+   public:
+    Stream(const std::vector<uint32_t> &data, uint32_t count) : data(data), count(count) {}
+    // Zero copy: the stream reads from (source) or writes to (sink) the bf16 mapping itself, which must outlive it.
+    // Throws std::invalid_argument for a non-bf16 file or one with more than 2^32 - 1 elements.
+    explicit Stream(MappedFile &file);
+    virtual ~Stream() = default;
+
+    // Number of tokens this stream produces (sources) or holds (sinks).
+    uint32_t size() const { return count; }
+
+   protected:
+    friend class CpuMap;
+    // Packed data: the mapping if there is one, else `data`.
+    std::span<uint32_t> words() { return mapped ? mapping : std::span<uint32_t>(data); }
+
+    std::vector<uint32_t> data;
+    uint32_t count;
+    std::span<uint32_t> mapping;
+    bool mapped = false;
+    bool read_only = false;
+};
+
+// out_token[t] = { table[index_vec[t * accesses_per_token + j]] for j in [0, accesses_per_token) }.
+// A kernel input fed by a gather stream sees the accesses as consecutive inputs in0..in{accesses_per_token - 1}.
+//
+// With CSR offsets instead, token t has its own arity: out_token[t] = { table[index_vec[j]] for j in [offsets[t],
+// offsets[t + 1]) }. The kernel sees in0..in{max_arity() - 1}, where accesses past a token's arity read as 0 (and are
+// never fetched), plus an input named `count` holding the token's arity.
+class GatherStream : public Stream {
+   public:
+    GatherStream(
+        const std::vector<uint32_t> &table,
+        uint32_t table_n_elements,
+        const std::vector<uint32_t> &index_vec,
+        uint8_t accesses_per_token = 1);
+    // CSR: `offsets` has one entry per token plus one, starting at 0, non-decreasing and ending at index_vec.size().
+    // Throws std::invalid_argument otherwise.
+    GatherStream(
+        const std::vector<uint32_t> &table,
+        uint32_t table_n_elements,
+        const std::vector<uint32_t> &offsets,
+        const std::vector<uint32_t> &index_vec);
+    // Zero copy over a bf16 table file and a UInt32 index file; both must outlive the stream.
+    GatherStream(MappedFile &table, MappedFile &index_file, uint8_t accesses_per_token = 1);
+
+    uint8_t accesses() const { return accesses_per_token; }
+    bool variable_arity() const { return !csr_offsets.empty(); }
+    // Largest number of accesses of any token.
+    uint32_t max_arity() const { return variable_arity() ? arity_max : accesses_per_token; }
+
+    // Issues reads in bank/page-sorted order within each tile and restores the original order as they arrive (see
+    // GatherPlan). Results are unchanged; plan() reports the locality gained. Kept up to date across rebinds.
+    // Fixed-arity streams only; throws std::invalid_argument for CSR.
+    void reorder(const DramGeometry &dram = {});
+    const std::optional<GatherPlan> &plan() const { return gather_plan; }
+
+   private:
+    friend class CpuMap;
+    // Indices in read order.
+    std::span<const uint32_t> index_span() const {
+        if (gather_plan) {
+            return gather_plan->indices;
+        }
+        return mapped ? index_mapping : std::span<const uint32_t>(indices);
+    }
+
+    std::vector<uint32_t> indices;
+    std::span<const uint32_t> index_mapping;
+    uint8_t accesses_per_token;
+    std::vector<uint32_t> csr_offsets;
+    uint32_t arity_max = 0;
+    std::optional<GatherPlan> gather_plan;
+    DramGeometry geometry;
+};
+
+// What a stencil tap reads when its neighbor falls outside the image.
+enum class Boundary {
+    Clamp,  // The nearest edge pixel.
+    Zero,   // 0, without a read.
+    Wrap,   // The pixel on the opposite edge (the image is a torus).
+};
+
+// A gather over a row-major width x height image whose indices are generated from each token's coordinates instead of
+// read from an index buffer: token t is pixel (t % width, t / width), and out_token[t] = { image[neighbor(t, j)] for
+// each tap j of `offsets` }. The kernel sees the taps as consecutive inputs in0..in{taps() - 1}, as for a gather.
+class StencilStream : public Stream {
+   public:
+    struct Offset {
+        int32_t dx = 0;
+        int32_t dy = 0;
+    };
+
+    // Throws std::invalid_argument for an empty image or stencil, or an image smaller than width * height.
+    StencilStream(
+        const std::vector<uint32_t> &image,
+        uint32_t width,
+        uint32_t height,
+        std::vector<Offset> offsets,
+        Boundary boundary = Boundary::Clamp);
+
+    // (2 * radius + 1)^2 window, row by row; a single row; a single column.
+    static std::vector<Offset> box(uint32_t radius);
+    static std::vector<Offset> row(uint32_t radius);
+    static std::vector<Offset> column(uint32_t radius);
+
+    uint32_t width() const { return image_width; }
+    uint32_t height() const { return image_height; }
+    uint32_t taps() const { return static_cast<uint32_t>(offsets.size()); }
+    Boundary boundary() const { return policy; }
+
+    // Image index that tap `tap` of `token` reads, or -1 if it reads 0 (Boundary::Zero, outside the image).
+    int64_t neighbor(uint32_t token, uint32_t tap) const {
+        int64_t w = image_width;
+        int64_t h = image_height;
+        int64_t x = int64_t{token % image_width} + offsets[tap].dx;
+        int64_t y = int64_t{token / image_width} + offsets[tap].dy;
+        switch (policy) {
+            case Boundary::Clamp:
+                x = std::clamp<int64_t>(x, 0, w - 1);
+                y = std::clamp<int64_t>(y, 0, h - 1);
+                break;
+            case Boundary::Zero:
+                if (x < 0 || x >= w || y < 0 || y >= h) {
+                    return -1;
+                }
+                break;
+            case Boundary::Wrap:
+                x = (x % w + w) % w;
+                y = (y % h + h) % h;
+                break;
+        }
+        return y * w + x;
+    }
+
+   private:
+    friend class CpuMap;
+    uint32_t image_width;
+    uint32_t image_height;
+    std::vector<Offset> offsets;
+    Boundary policy;
+};
+
+// How a ScatterStream combines a value with what its destination already holds.
+enum class ScatterOp {
+    Overwrite,  // The value replaces it; among duplicate indices the last token wins.
+    Add,
+    Max,
+    Min,
+};
+
+// The inverse of a gather: a sink that writes token t of its producer to table[index_vec[t]] with `op`, instead of to
+// position t. Duplicate indices are combined in fp32 before the table is written back, so an Add scatter is rounded to
+// bf16 once per element rather than once per contribution. read_stream() returns the table.
+class ScatterStream : public Stream {
+   public:
+    // Throws std::invalid_argument if an index is out of range or the table is smaller than table_n_elements.
+    ScatterStream(
+        const std::vector<uint32_t> &table,
+        uint32_t table_n_elements,
+        const std::vector<uint32_t> &index_vec,
+        ScatterOp op = ScatterOp::Overwrite);
+
+    ScatterOp op() const { return scatter_op; }
+    uint32_t table_size() const { return table_n_elements; }
+
+   private:
+    friend class CpuMap;
+    std::vector<uint32_t> indices;
+    uint32_t table_n_elements;
+    ScatterOp scatter_op;
+};
+
+enum class ReduceOp {
+    Sum,
+    Min,
+    Max,
+    Mean,
+    ArgMax,
+};
+
+// A sink that keeps a reduction of its producer's tokens instead of the tokens: one result per group of `group_size`
+// consecutive tokens (0 = one group, a scalar), so only the results are read back. Each core reduces its own tiles in
+// fp32, then the per-core partials of every group are combined pairwise in a tree, as over the NoC. read_stream()
+// returns the results packed as bf16; ArgMax packs each group's maximum and reports positions through indices().
+class ReduceStream : public Stream {
+   public:
+    // `count` is the number of tokens reduced.
+    ReduceStream(ReduceOp op, uint32_t count, uint32_t group_size = 0);
+
+    ReduceOp op() const { return reduce_op; }
+    uint32_t num_groups() const { return static_cast<uint32_t>(partials.size()); }
+    // Results of the last execute(), one per group, in fp32.
+    const std::vector<float> &values() const { return results; }
+    // ArgMax: each group's maximum, as a position within the group (the first, on ties).
+    const std::vector<uint32_t> &indices() const { return result_indices; }
+
+   private:
+    friend class CpuMap;
+    struct Partial {
+        float value;
+        uint32_t index;
+        uint32_t count;
+    };
+    Partial identity() const;
+    Partial combine(const Partial &a, const Partial &b) const;
+    // Folds tokens [first, first + n) (packed bf16 from `packed`) into the partials, one task per core of `split`.
+    void accumulate(const uint32_t *packed, size_t first, size_t n, const WorkSplit &split, ThreadPool &pool);
+    void finish(Rounding rounding);
+
+    ReduceOp reduce_op;
+    uint32_t group_size;
+    std::vector<Partial> partials;
+    std::vector<float> results;
+    std::vector<uint32_t> result_indices;
+};
+
+// A sink that receives the prefix sum of its producer's tokens rather than the tokens. Each chunk is scanned in two
+// passes over the cores of the split: every core sums its tiles, the core totals are scanned into per-core carries
+// (starting from the carry of the chunks before), then every core scans its tiles from its carry. Carries stay fp32;
+// only the outputs are rounded to bf16.
+class ScanStream : public Stream {
+   public:
+    ScanStream(const std::vector<uint32_t> &data, uint32_t count, ScanKind kind = ScanKind::Inclusive) :
+        Stream(data, count), scan_kind(kind) {}
+
+    ScanKind kind() const { return scan_kind; }
+
+   private:
+    friend class CpuMap;
+    // Scans tokens [first, first + n) (packed bf16 from `packed`) into the sink, continuing from `carry`.
+    void scan(
+        const uint32_t *packed, size_t first, size_t n, const WorkSplit &split, ThreadPool &pool, Rounding rounding);
+
+    ScanKind scan_kind;
+    float carry = 0.0F;
+};
+
+// Executes a Kernel/Stream graph on the host: tiles are split across a thread pool, inputs are widened to fp32 with
+// SIMD and every arithmetic op is rounded back to bf16 so results track what the device produces.
+class CpuMap {
+   public:
+    // num_threads == 0 uses every host core.
+    CpuMap(std::vector<Kernel *> kernels, std::vector<Stream *> streams, size_t num_threads = 0);
+    ~CpuMap();
+
+    void add_connection(Stream *src, Kernel *dst, const std::string &dst_port);
+    void add_connection(Kernel *src, const std::string &src_port, Kernel *dst, const std::string &dst_port);
+    void add_connection(Kernel *src, const std::string &src_port, Stream *dst);
+
+    void set_rounding(Rounding mode) { rounding = mode; }
+
+    // Spread each kernel's tiles over at most `max_cores` cores of `grid` (0 = every core), as current::Map's
+    // max_parallelization_factor does. Each core's range runs as one host task.
+    void set_parallelization(uint32_t max_cores, CoreGrid grid = {}) {
+        parallelization = max_cores;
+        core_grid = grid;
+    }
+    // Stream `tiles` tiles at a time instead of whole streams (0, the default). Transfers of the next and previous
+    // chunk overlap the current one, and intermediate buffers hold two chunks whatever the stream length. Unchunked,
+    // stages read sources in place and write outputs bound only for a sink straight into it.
+    void set_chunk_tiles(uint32_t tiles) { chunk_tiles = tiles; }
+    // Bytes held by staging and intermediate buffers after the last execute().
+    size_t buffer_bytes() const;
+
+    // Core assignment used by each stage of the last execute() (its first chunk), in plan() order.
+    const std::vector<WorkSplit> &core_assignment() const { return splits; }
+
+    // Linear chains of kernels (each link a single-output kernel whose output feeds exactly one other kernel) are fused
+    // into one kernel by default, so intermediates stay in registers instead of round-tripping through a buffer.
+    void set_fusion(bool enabled) {
+        fusion = enabled;
+        compiled.reset();
+    }
+
+    // Kernels that execute together as one fused kernel, and the tile ops that kernel needs per tile.
+    struct Stage {
+        std::vector<Kernel *> kernels;
+        expr::OpCounts ops;
+    };
+    // The stages execute() would run, in order.
+    std::vector<Stage> plan() const;
+
+    // With a cache set, compiled stages are looked up by cache_key() and only compiled (and stored) on a miss. The
+    // cache must outlive the map.
+    void set_kernel_cache(KernelCache *kernel_cache) {
+        cache = kernel_cache;
+        compiled.reset();
+    }
+    // Digest of the graph topology, stream formats, expression text and fusion setting. Device code generation
+    // extends it with tiles_per_cb and the parallelization factor.
+    CacheKey cache_key() const;
+
+    // The graph is compiled on the first call and reused by later calls until a connection or compile setting
+    // changes, so a map can be executed any number of times. Returns the per-phase timings and traffic of this call.
+    ExecutionStats execute();
+
+    // Replace the host data bound to a stream (source, sink, stencil image or scatter table) between executions. Token
+    // counts are baked into the compiled graph, so the new data must cover the stream's size() (a scatter's
+    // table_size()). Throws std::invalid_argument otherwise.
+    void rebind(Stream *stream, const std::vector<uint32_t> &data);
+    // Same for a gather stream: the table, of which the first table_n_elements values are used (so it must hold at
+    // least that many), and the index vector, which must keep the number of tokens.
+    void rebind(GatherStream *stream, const std::vector<uint32_t> &table, const std::vector<uint32_t> &index_vec);
+
+    std::vector<uint32_t> read_stream(Stream *stream) const;
+
+    // Theoretical traffic of one execute() on the device, for roofline(): every stage's tiles split over cores as
+    // set_parallelization() says, streams interleaved page by page over the DRAM banks of `dram` starting at bank 0.
+    // Source and sink streams, gather index buffers and unfused intermediates are streamed; a gather table or stencil
+    // image that fits `l1_budget` is copied whole into every core that reads it, a larger one is read a chunk per
+    // access (reusing the previous chunk as the device reader does). A scatter reads and writes a chunk per token.
+    Traffic traffic(const DramGeometry &dram = {}, uint32_t l1_budget = DEFAULT_SHARD_BUDGET) const;
+
+   private:
+    struct Endpoint {
+        Stream *stream = nullptr;
+        Kernel *kernel = nullptr;
+        size_t port = 0;
+    };
+    struct Connection {
+        Endpoint src;
+        Endpoint dst;
+    };
+
+    struct StageInput {
+        Stream *stream = nullptr;  // Stream source (with the gather access it reads) ...
+        uint32_t access = 0;
+        Kernel *kernel = nullptr;  // ... or an upstream kernel's output port.
+        size_t port = 0;
+    };
+    struct CompiledStage {
+        std::vector<Kernel *> kernels;
+        expr::Program program;
+        std::vector<StageInput> inputs;  // One per program input slot.
+    };
+
+    std::vector<CompiledStage> compile_stages() const;
+    // The stages compiled by the first of execute(), plan() or traffic(), kept until a compile setting changes.
+    const std::vector<CompiledStage> &compiled_stages() const;
+    std::vector<CompiledStage> build_stages() const;
+    CacheEntry encode(const std::vector<CompiledStage> &stages) const;
+    std::vector<CompiledStage> decode(const CacheEntry &entry) const;
+    size_t input_port_index(Kernel *kernel, const std::string &port) const;
+    size_t output_port_index(Kernel *kernel, const std::string &port) const;
+    std::vector<Kernel *> topological_order() const;
+    static uint64_t traffic_bytes(Stream *stream);
+
+    std::vector<Kernel *> kernels;
+    std::vector<Stream *> streams;
+    std::vector<Connection> connections;
+    std::unique_ptr<ThreadPool> own_pool;
+    ThreadPool *pool;
+    Rounding rounding = Rounding::NearestEven;
+    uint32_t parallelization = 0;
+    uint32_t chunk_tiles = 0;
+    CoreGrid core_grid;
+    bool fusion = true;
+    KernelCache *cache = nullptr;
+
+    // State kept across execute() calls.
+    mutable std::optional<std::vector<CompiledStage>> compiled;
+    // Gather and stencil tables widened to fp32 (unless mapped), dropped on rebind; scatter tables while they
+    // accumulate.
+    std::map<Stream *, std::vector<float>> tables;
+    // Double-buffered chunk slots: staged source data and packed outputs per (kernel, port).
+    struct Slot {
+        std::map<Stream *, std::vector<uint32_t>> inputs;
+        std::map<std::pair<Kernel *, size_t>, std::vector<uint32_t>> outputs;
+        std::map<Stream *, std::vector<uint32_t>> read_offsets;  // Staged GatherPlan::read_offsets.
+        std::map<Stream *, std::vector<uint32_t>> csr_offsets;   // Staged CSR offsets (one more than tokens).
+    };
+    std::array<Slot, 2> slots;
+    std::vector<WorkSplit> splits;
+};
+
+}  // namespace current::host
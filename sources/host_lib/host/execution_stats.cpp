@@ -0,0 +1,54 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "execution_stats.hpp"
+
+#include <iomanip>
+#include <sstream>
+#include <utility>
+
+namespace current::host {
+
+double gbps(uint64_t bytes, ExecutionStats::Duration duration) {
+    double seconds = std::chrono::duration<double>(duration).count();
+    return seconds > 0.0 ? static_cast<double>(bytes) / seconds / 1e9 : 0.0;
+}
+
+uint64_t ExecutionStats::bytes() const {
+    uint64_t total_bytes = 0;
+    for (const auto &stream : streams) {
+        total_bytes += stream.bytes;
+    }
+    return total_bytes;
+}
+
+double ExecutionStats::gbps() const { return host::gbps(bytes(), total); }
+
+std::string ExecutionStats::describe() const {
+    auto ms = [](Duration duration) { return std::chrono::duration<double, std::milli>(duration).count(); };
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    const std::pair<const char *, Duration> phases[] = {
+        {"validation", validation},
+        {"generation", generation},
+        {"compilation", compilation},
+        {"allocation", allocation},
+        {"host->device", host_to_device},
+        {"device", device},
+        {"readback", readback},
+        {"total", total},
+    };
+    for (const auto &[name, duration] : phases) {
+        out << std::setw(14) << std::left << name << std::right << std::setw(12) << ms(duration) << " ms\n";
+    }
+    for (size_t i = 0; i < streams.size(); i++) {
+        out << "stream " << std::setw(6) << std::left << i << std::right << std::setw(12) << streams[i].bytes
+            << " bytes " << std::setw(10) << streams[i].gbps << " GB/s\n";
+    }
+    out << std::setw(13) << std::left << "overall" << std::right << std::setw(12) << bytes() << " bytes "
+        << std::setw(10) << gbps() << " GB/s\n";
+    return out.str();
+}
+
+}  // namespace current::host
@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace current::host {
+
+class Stream;
+
+// Bytes one stream moved between host and device in an execution: packed data for sources and sinks, plus the index
+// (and CSR offset) buffers and the resident table of a gather, or the table in and out of a scatter.
+struct StreamTraffic {
+    const Stream *stream = nullptr;
+    uint64_t bytes = 0;
+    double gbps = 0.0;  // Over the whole execution.
+};
+
+// Where one execute() spent its time, phase by phase, and the traffic it moved. A phase a backend does not have (the
+// host builds no device binaries) stays zero. Transfers of a chunked execution overlap its run, so the phases are
+// busy times and can add up to more than `total`.
+struct ExecutionStats {
+    using Duration = std::chrono::steady_clock::duration;
+
+    Duration validation{};      // Token counts of every stage.
+    Duration generation{};      // Per-stage programs, built or loaded from the kernel cache; zero once compiled.
+    Duration compilation{};     // Device binaries.
+    Duration allocation{};      // Sink checks and buffers, scatter tables, reduce and scan state.
+    Duration host_to_device{};  // Staging inputs and widening resident tables.
+    Duration device{};          // Running the stages.
+    Duration readback{};        // Draining results into sinks.
+    Duration total{};
+    std::vector<StreamTraffic> streams;  // In the map's stream order.
+
+    uint64_t bytes() const;
+    // All streams' bytes over `total`.
+    double gbps() const;
+    // One line per phase, then one per stream, then the overall figure.
+    std::string describe() const;
+};
+
+// Bytes per second in GB/s; 0 for an empty duration.
+double gbps(uint64_t bytes, ExecutionStats::Duration duration);
+
+}  // namespace current::host
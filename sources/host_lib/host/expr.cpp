@@ -0,0 +1,650 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "expr.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <functional>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <tuple>
+
+namespace current::host::expr {
+
+namespace {
+
+constexpr uint32_t NONE = UINT32_MAX;
+
+bool is_power_of_two(float value) {
+    int exponent = 0;
+    return value != 0.0F && std::isfinite(value) && std::fabs(std::frexp(value, &exponent)) == 0.5F;
+}
+
+float evaluate(Op op, float a, float b) {
+    switch (op) {
+        case Op::Add: return a + b;
+        case Op::Sub: return a - b;
+        case Op::Mul: return a * b;
+        case Op::Div: return a / b;
+        case Op::Neg: return -a;
+        default: return 0.0F;
+    }
+}
+
+// Builds the DAG, applying folding / strength reduction as nodes are created and hash-consing them for CSE.
+class Builder {
+   public:
+    explicit Builder(const Options &options) : options(options) {}
+
+    uint32_t input(uint32_t slot) { return intern({Op::Input, 0, 0, slot}); }
+
+    uint32_t constant(float value) { return intern({Op::Constant, 0, 0, 0, value}); }
+
+    uint32_t neg(uint32_t a) {
+        if (options.fold_constants) {
+            if (auto c = constant_value(a)) {
+                return constant(-*c);
+            }
+            if (nodes[a].op == Op::Neg) {
+                return nodes[a].lhs;
+            }
+        }
+        return intern({Op::Neg, a});
+    }
+
+    uint32_t binary(Op op, uint32_t a, uint32_t b) {
+        auto ca = constant_value(a);
+        auto cb = constant_value(b);
+        if (options.fold_constants) {
+            if (ca && cb) {
+                return constant(evaluate(op, *ca, *cb));
+            }
+            if ((op == Op::Add && cb == 0.0F) || (op == Op::Sub && cb == 0.0F) || (op == Op::Mul && cb == 1.0F) ||
+                (op == Op::Div && cb == 1.0F)) {
+                return a;
+            }
+            if ((op == Op::Add && ca == 0.0F) || (op == Op::Mul && ca == 1.0F)) {
+                return b;
+            }
+        }
+        if (options.reduce_strength) {
+            // x - c -> x + (-c), 0 - x -> -x: one canonical form for scalar ops.
+            if (op == Op::Sub && cb) {
+                return binary(Op::Add, a, constant(-*cb));
+            }
+            if (op == Op::Sub && ca == 0.0F) {
+                return neg(b);
+            }
+            // Dividing by a power of two is a multiply by its reciprocal, which is then exact; the SFPU divide is
+            // several times slower. Other divisors keep the divide, since x * (1 / c) can round differently.
+            if (op == Op::Div && cb && is_power_of_two(*cb) && is_power_of_two(1.0F / *cb)) {
+                return binary(Op::Mul, a, constant(1.0F / *cb));
+            }
+            if (op == Op::Mul && (ca || cb)) {
+                uint32_t x = cb ? a : b;
+                float c = cb ? *cb : *ca;
+                if (c == -1.0F) {
+                    return neg(x);
+                }
+                // x * 2 -> x + x moves the op off the SFPU and is exact.
+                if (c == 2.0F) {
+                    return binary(Op::Add, x, x);
+                }
+                // (x * c1) * c2 -> x * (c1 * c2) when one factor is a power of two, so the result is unchanged.
+                // x + x counts as x * 2, which matters once fusion puts a producer's doubling next to a scale.
+                auto inner = nodes[x].op == Op::Mul ? constant_value(nodes[x].rhs) : std::nullopt;
+                if (nodes[x].op == Op::Add && nodes[x].lhs == nodes[x].rhs) {
+                    inner = 2.0F;
+                }
+                if (inner && (is_power_of_two(*inner) || is_power_of_two(c))) {
+                    return binary(Op::Mul, nodes[x].lhs, constant(*inner * c));
+                }
+            }
+        }
+        // Canonical operand order for commutative ops: constants on the right, then by node id.
+        if ((op == Op::Add || op == Op::Mul) && (ca || (!cb && a > b))) {
+            std::swap(a, b);
+        }
+        return intern({op, a, b});
+    }
+
+    std::vector<Node> nodes;
+
+   private:
+    std::optional<float> constant_value(uint32_t id) const {
+        if (nodes[id].op == Op::Constant) {
+            return nodes[id].value;
+        }
+        return std::nullopt;
+    }
+
+    uint32_t intern(Node node) {
+        auto key = std::make_tuple(node.op, node.lhs, node.rhs, node.input, std::bit_cast<uint32_t>(node.value));
+        if (options.eliminate_common_subexpressions) {
+            auto it = table.find(key);
+            if (it != table.end()) {
+                return it->second;
+            }
+        }
+        auto id = static_cast<uint32_t>(nodes.size());
+        nodes.push_back(node);
+        table[key] = id;
+        return id;
+    }
+
+    const Options &options;
+    std::map<std::tuple<Op, uint32_t, uint32_t, uint32_t, uint32_t>, uint32_t> table;
+};
+
+class Parser {
+   public:
+    Parser(
+        const std::string &source,
+        const std::vector<std::string> &inputs,
+        const std::vector<std::string> &outputs,
+        Builder &builder) :
+        src(source), inputs(inputs), outputs(outputs), builder(builder), assigned(outputs.size(), NONE) {}
+
+    std::vector<uint32_t> parse() {
+        skip_space();
+        while (pos < src.size()) {
+            auto target = identifier();
+            expect('=');
+            uint32_t value = expression();
+            auto out = std::find(outputs.begin(), outputs.end(), target);
+            if (out != outputs.end()) {
+                assigned[out - outputs.begin()] = value;
+            } else {
+                temporaries[target] = value;
+            }
+            if (!consume(';') && pos < src.size()) {
+                fail("expected ';'");
+            }
+        }
+        for (size_t i = 0; i < outputs.size(); i++) {
+            if (assigned[i] == NONE) {
+                throw std::invalid_argument("compute kernel: output " + outputs[i] + " is never assigned");
+            }
+        }
+        return assigned;
+    }
+
+   private:
+    uint32_t expression() {
+        uint32_t value = term();
+        while (true) {
+            if (consume('+')) {
+                value = builder.binary(Op::Add, value, term());
+            } else if (consume('-')) {
+                value = builder.binary(Op::Sub, value, term());
+            } else {
+                return value;
+            }
+        }
+    }
+
+    uint32_t term() {
+        uint32_t value = unary();
+        while (true) {
+            if (consume('*')) {
+                value = builder.binary(Op::Mul, value, unary());
+            } else if (consume('/')) {
+                value = builder.binary(Op::Div, value, unary());
+            } else {
+                return value;
+            }
+        }
+    }
+
+    uint32_t unary() {
+        if (consume('-')) {
+            return builder.neg(unary());
+        }
+        if (consume('(')) {
+            uint32_t value = expression();
+            expect(')');
+            return value;
+        }
+        if (pos < src.size() && (std::isdigit(static_cast<unsigned char>(src[pos])) || src[pos] == '.')) {
+            // from_chars rather than stof: locale-independent, no hex, and out-of-range literals are a parse error.
+            float value = 0.0F;
+            auto [end, error] = std::from_chars(src.data() + pos, src.data() + src.size(), value);
+            if (error != std::errc()) {
+                fail("invalid number");
+            }
+            pos = end - src.data();
+            if (pos < src.size() && (src[pos] == 'f' || src[pos] == 'F')) {
+                pos++;
+            }
+            skip_space();
+            return builder.constant(value);
+        }
+        return name(identifier());
+    }
+
+    uint32_t name(const std::string &id) {
+        if (auto it = temporaries.find(id); it != temporaries.end()) {
+            return it->second;
+        }
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (inputs[i] == id) {
+                return builder.input(i);
+            }
+        }
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (id == "in" + std::to_string(i)) {
+                return builder.input(i);
+            }
+        }
+        fail("unknown name " + id);
+    }
+
+    std::string identifier() {
+        size_t start = pos;
+        while (pos < src.size() && (std::isalnum(static_cast<unsigned char>(src[pos])) || src[pos] == '_')) {
+            pos++;
+        }
+        if (start == pos) {
+            fail("expected identifier");
+        }
+        auto id = src.substr(start, pos - start);
+        skip_space();
+        return id;
+    }
+
+    bool consume(char c) {
+        if (pos < src.size() && src[pos] == c) {
+            pos++;
+            skip_space();
+            return true;
+        }
+        return false;
+    }
+
+    void expect(char c) {
+        if (!consume(c)) {
+            fail(std::string("expected '") + c + "'");
+        }
+    }
+
+    void skip_space() {
+        while (pos < src.size()) {
+            if (std::isspace(static_cast<unsigned char>(src[pos]))) {
+                pos++;
+            } else if (src.compare(pos, 2, "//") == 0) {
+                pos = std::min(src.size(), src.find('\n', pos));
+            } else {
+                return;
+            }
+        }
+    }
+
+    [[noreturn]] void fail(const std::string &msg) const {
+        throw std::invalid_argument("compute kernel: " + msg + " at offset " + std::to_string(pos));
+    }
+
+    const std::string &src;
+    const std::vector<std::string> &inputs;
+    const std::vector<std::string> &outputs;
+    Builder &builder;
+    std::map<std::string, uint32_t> temporaries;
+    std::vector<uint32_t> assigned;
+    size_t pos = 0;
+};
+
+}  // namespace
+
+size_t Program::arithmetic_ops() const {
+    return std::count_if(nodes.begin(), nodes.end(), [](const Node &n) {
+        return n.op != Op::Input && n.op != Op::Constant;
+    });
+}
+
+namespace {
+
+// Dead node elimination: keep only what `roots` reach, preserving topological order.
+Program finalize(const std::vector<Node> &nodes, const std::vector<uint32_t> &roots, size_t num_inputs) {
+    std::vector<bool> live(nodes.size(), false);
+    for (auto root : roots) {
+        live[root] = true;
+    }
+    for (size_t i = nodes.size(); i-- > 0;) {
+        const auto &node = nodes[i];
+        if (!live[i]) {
+            continue;
+        }
+        if (node.op != Op::Input && node.op != Op::Constant) {
+            live[node.lhs] = true;
+            if (node.op != Op::Neg) {
+                live[node.rhs] = true;
+            }
+        }
+    }
+
+    Program program;
+    program.live_inputs.assign(num_inputs, false);
+    std::vector<uint32_t> remap(nodes.size(), NONE);
+    for (size_t i = 0; i < nodes.size(); i++) {
+        if (!live[i]) {
+            continue;
+        }
+        auto node = nodes[i];
+        if (node.op == Op::Input) {
+            program.live_inputs[node.input] = true;
+        } else if (node.op != Op::Constant) {
+            node.lhs = remap[node.lhs];
+            node.rhs = node.op == Op::Neg ? 0 : remap[node.rhs];
+        }
+        remap[i] = static_cast<uint32_t>(program.nodes.size());
+        program.nodes.push_back(node);
+    }
+    for (auto root : roots) {
+        program.outputs.push_back(remap[root]);
+    }
+    return program;
+}
+
+// Re-emits `program` through `builder`, with input slots mapped by `input_node`. Returns the new node ids.
+std::vector<uint32_t> replay(
+    const Program &program, Builder &builder, const std::function<uint32_t(uint32_t)> &input_node) {
+    std::vector<uint32_t> ids(program.nodes.size());
+    for (size_t i = 0; i < program.nodes.size(); i++) {
+        const auto &node = program.nodes[i];
+        switch (node.op) {
+            case Op::Input: ids[i] = input_node(node.input); break;
+            case Op::Constant: ids[i] = builder.constant(node.value); break;
+            case Op::Neg: ids[i] = builder.neg(ids[node.lhs]); break;
+            default: ids[i] = builder.binary(node.op, ids[node.lhs], ids[node.rhs]); break;
+        }
+    }
+    return ids;
+}
+
+}  // namespace
+
+Program compile(
+    const std::string &source,
+    const std::vector<std::string> &inputs,
+    const std::vector<std::string> &outputs,
+    const Options &options) {
+    if (inputs.empty()) {
+        throw std::invalid_argument("compute kernel: no inputs");
+    }
+    Builder builder(options);
+    std::vector<uint32_t> roots;
+    if (source.find_first_not_of(" \t\r\n") == std::string::npos) {
+        roots.assign(outputs.size(), builder.input(0));
+    } else {
+        roots = Parser(source, inputs, outputs, builder).parse();
+    }
+    return finalize(builder.nodes, roots, inputs.size());
+}
+
+Program fuse(const Program &producer, uint32_t port, const Program &consumer, uint32_t slot, const Options &options) {
+    if (port >= producer.outputs.size() || slot >= consumer.live_inputs.size()) {
+        throw std::invalid_argument("fuse: port or slot out of range");
+    }
+    Builder builder(options);
+    auto producer_inputs = static_cast<uint32_t>(producer.live_inputs.size());
+    auto producer_ids = replay(producer, builder, [&](uint32_t input) { return builder.input(input); });
+    auto consumer_ids = replay(consumer, builder, [&](uint32_t input) {
+        if (input == slot) {
+            return producer_ids[producer.outputs[port]];
+        }
+        return builder.input(producer_inputs + (input < slot ? input : input - 1));
+    });
+
+    std::vector<uint32_t> roots;
+    for (auto out : consumer.outputs) {
+        roots.push_back(consumer_ids[out]);
+    }
+    return finalize(builder.nodes, roots, producer_inputs + consumer.live_inputs.size() - 1);
+}
+
+std::string serialize(const Program &program) {
+    std::ostringstream out;
+    out << "program " << program.nodes.size() << " " << program.outputs.size() << " " << program.live_inputs.size()
+        << "\n";
+    for (const auto &node : program.nodes) {
+        out << static_cast<unsigned>(node.op) << " " << node.lhs << " " << node.rhs << " " << node.input << " "
+            << std::bit_cast<uint32_t>(node.value) << "\n";
+    }
+    for (auto id : program.outputs) {
+        out << id << " ";
+    }
+    out << "\n";
+    for (bool live : program.live_inputs) {
+        out << (live ? 1 : 0) << " ";
+    }
+    out << "\n";
+    return out.str();
+}
+
+Program deserialize(const std::string &text) {
+    auto fail = [] { throw std::invalid_argument("deserialize: malformed program"); };
+    std::istringstream in(text);
+    std::string tag;
+    size_t num_nodes = 0;
+    size_t num_outputs = 0;
+    size_t num_inputs = 0;
+    if (!(in >> tag >> num_nodes >> num_outputs >> num_inputs) || tag != "program") {
+        fail();
+    }
+    Program program;
+    for (size_t i = 0; i < num_nodes; i++) {
+        unsigned op = 0;
+        uint32_t bits = 0;
+        Node node{};
+        if (!(in >> op >> node.lhs >> node.rhs >> node.input >> bits) || op > static_cast<unsigned>(Op::Neg)) {
+            fail();
+        }
+        node.op = static_cast<Op>(op);
+        node.value = std::bit_cast<float>(bits);
+        bool operands_ok = node.op == Op::Constant || (node.op == Op::Input ? node.input < num_inputs
+                                                                            : node.lhs < i && node.rhs < i);
+        if (!operands_ok) {
+            fail();
+        }
+        program.nodes.push_back(node);
+    }
+    program.outputs.resize(num_outputs);
+    for (auto &id : program.outputs) {
+        if (!(in >> id) || id >= num_nodes) {
+            fail();
+        }
+    }
+    for (size_t i = 0; i < num_inputs; i++) {
+        int live = 0;
+        if (!(in >> live)) {
+            fail();
+        }
+        program.live_inputs.push_back(live != 0);
+    }
+    return program;
+}
+
+OpCounts Schedule::counts() const {
+    OpCounts counts;
+    for (const auto &op : ops) {
+        switch (op.kind) {
+            case TileOpKind::CopyTile:
+            case TileOpKind::CopyDest:
+            case TileOpKind::FillTile: counts.copies++; break;
+            case TileOpKind::FpuBinary: counts.fpu++; break;
+            case TileOpKind::SfpuBinary:
+            case TileOpKind::SfpuScalar:
+            case TileOpKind::SfpuNeg: counts.sfpu++; break;
+            case TileOpKind::PackTile: counts.packs++; break;
+        }
+    }
+    return counts;
+}
+
+Schedule schedule(const Program &program) {
+    const auto &nodes = program.nodes;
+    Schedule result;
+    std::vector<uint32_t> reg_of(nodes.size(), NONE);
+    std::vector<uint32_t> remaining(nodes.size(), 0);
+    for (const auto &node : nodes) {
+        if (node.op != Op::Input && node.op != Op::Constant) {
+            remaining[node.lhs]++;
+            if (node.op != Op::Neg) {
+                remaining[node.rhs]++;
+            }
+        }
+    }
+    for (auto out : program.outputs) {
+        remaining[out]++;
+    }
+
+    std::vector<bool> busy;
+    auto acquire = [&]() -> uint32_t {
+        for (uint32_t r = 0; r < busy.size(); r++) {
+            if (!busy[r]) {
+                busy[r] = true;
+                return r;
+            }
+        }
+        if (busy.size() == MAX_DEST_REGISTERS) {
+            throw std::runtime_error("compute kernel needs more than 8 live dest tiles");
+        }
+        busy.push_back(true);
+        result.dest_registers = std::max<uint32_t>(result.dest_registers, busy.size());
+        return busy.size() - 1;
+    };
+    auto emit = [&](TileOp op) { result.ops.push_back(op); };
+
+    // Dest register holding `id`, loading inputs / constants on first use.
+    auto materialize = [&](uint32_t id) -> uint32_t {
+        if (reg_of[id] != NONE) {
+            return reg_of[id];
+        }
+        uint32_t r = acquire();
+        if (nodes[id].op == Op::Input) {
+            emit({.kind = TileOpKind::CopyTile, .dst = r, .cb_a = nodes[id].input});
+        } else {
+            emit({.kind = TileOpKind::FillTile, .dst = r, .scalar = nodes[id].value});
+        }
+        reg_of[id] = r;
+        return r;
+    };
+    // Dest register holding `id` that the current node may overwrite in place.
+    auto writable = [&](uint32_t id, uint32_t uses_here) -> uint32_t {
+        if (remaining[id] > uses_here) {
+            uint32_t r = acquire();
+            if (reg_of[id] != NONE) {
+                emit({.kind = TileOpKind::CopyDest, .dst = r, .src = reg_of[id]});
+            } else if (nodes[id].op == Op::Input) {
+                emit({.kind = TileOpKind::CopyTile, .dst = r, .cb_a = nodes[id].input});
+            } else {
+                emit({.kind = TileOpKind::FillTile, .dst = r, .scalar = nodes[id].value});
+            }
+            return r;
+        }
+        uint32_t r = materialize(id);
+        reg_of[id] = NONE;  // Ownership moves to the node being computed.
+        return r;
+    };
+    auto release = [&](uint32_t id) {
+        if (--remaining[id] == 0 && reg_of[id] != NONE) {
+            busy[reg_of[id]] = false;
+            reg_of[id] = NONE;
+        }
+    };
+
+    for (uint32_t id = 0; id < nodes.size(); id++) {
+        const auto &node = nodes[id];
+        if (node.op == Op::Input || node.op == Op::Constant) {
+            continue;
+        }
+        if (node.op == Op::Neg) {
+            uint32_t r = writable(node.lhs, 1);
+            emit({.kind = TileOpKind::SfpuNeg, .op = Op::Neg, .dst = r});
+            release(node.lhs);
+            reg_of[id] = r;
+            continue;
+        }
+
+        const auto &a = nodes[node.lhs];
+        const auto &b = nodes[node.rhs];
+        uint32_t uses_a = node.lhs == node.rhs ? 2 : 1;
+        uint32_t r = NONE;
+        if (b.op == Op::Constant && a.op != Op::Constant) {
+            r = writable(node.lhs, uses_a);
+            emit({.kind = TileOpKind::SfpuScalar, .op = node.op, .dst = r, .scalar = b.value});
+        } else if (a.op == Op::Constant && node.op != Op::Div) {
+            r = writable(node.rhs, 1);
+            emit({.kind = TileOpKind::SfpuScalar,
+                  .op = node.op,
+                  .dst = r,
+                  .scalar = a.value,
+                  .reversed = node.op == Op::Sub});
+        } else if (
+            a.op == Op::Input && b.op == Op::Input && node.op != Op::Div && reg_of[node.lhs] == NONE &&
+            reg_of[node.rhs] == NONE) {
+            // Both operands still sit in CBs: one FPU op, no copies.
+            r = acquire();
+            emit({.kind = TileOpKind::FpuBinary, .op = node.op, .dst = r, .cb_a = a.input, .cb_b = b.input});
+        } else {
+            r = writable(node.lhs, uses_a);
+            uint32_t s = node.lhs == node.rhs ? r : materialize(node.rhs);
+            emit({.kind = TileOpKind::SfpuBinary, .op = node.op, .dst = r, .src = s});
+        }
+        release(node.lhs);
+        release(node.rhs);
+        reg_of[id] = r;
+    }
+
+    for (uint32_t port = 0; port < program.outputs.size(); port++) {
+        uint32_t id = program.outputs[port];
+        emit({.kind = TileOpKind::PackTile, .dst = materialize(id), .cb_a = port});
+    }
+    for (auto id : program.outputs) {
+        release(id);
+    }
+    return result;
+}
+
+std::string Schedule::render() const {
+    auto op_name = [](Op op) {
+        switch (op) {
+            case Op::Add: return "add";
+            case Op::Sub: return "sub";
+            case Op::Mul: return "mul";
+            case Op::Div: return "div";
+            default: return "?";
+        }
+    };
+    std::ostringstream out;
+    out.precision(9);
+    for (const auto &op : ops) {
+        switch (op.kind) {
+            case TileOpKind::CopyTile: out << "copy_tile(cb_in" << op.cb_a << ", 0, " << op.dst << ");\n"; break;
+            case TileOpKind::CopyDest: out << "copy_dest_values(" << op.dst << ", " << op.src << ");\n"; break;
+            case TileOpKind::FillTile: out << "fill_tile(" << op.dst << ", " << op.scalar << "f);\n"; break;
+            case TileOpKind::FpuBinary:
+                out << op_name(op.op) << "_tiles(cb_in" << op.cb_a << ", cb_in" << op.cb_b << ", 0, 0, " << op.dst
+                    << ");\n";
+                break;
+            case TileOpKind::SfpuBinary:
+                out << op_name(op.op) << "_binary_tile(" << op.dst << ", " << op.src << ");\n";
+                break;
+            case TileOpKind::SfpuScalar:
+                out << (op.reversed ? "r" : "") << op_name(op.op) << "_unary_tile(" << op.dst << ", " << op.scalar
+                    << "f);\n";
+                break;
+            case TileOpKind::SfpuNeg: out << "negative_tile(" << op.dst << ");\n"; break;
+            case TileOpKind::PackTile: out << "pack_tile(" << op.dst << ", cb_out" << op.cb_a << ");\n"; break;
+        }
+    }
+    return out.str();
+}
+
+}  // namespace current::host::expr
@@ -0,0 +1,119 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace current::host::expr {
+
+// Compiler for the set_compute_kernel expression language:
+//
+//     out0 = (in0 + in1 + in2) * 0.33;
+//
+// Statements are `name = expr;` with + - * / unary minus, parentheses, float literals and names. Names on the left
+// that are not output ports are temporaries. The result is a CSE'd DAG (Program) that has already been constant
+// folded, strength reduced and stripped of dead nodes, plus a tile-op schedule for the compute core.
+
+enum class Op : uint8_t { Input, Constant, Add, Sub, Mul, Div, Neg };
+
+struct Node {
+    Op op;
+    uint32_t lhs = 0;    // Operand node ids (lhs only for Neg).
+    uint32_t rhs = 0;
+    uint32_t input = 0;  // Input slot for Op::Input.
+    float value = 0.0F;  // Op::Constant.
+};
+
+struct Program {
+    // Topologically ordered: operands always precede their users.
+    std::vector<Node> nodes;
+    // Node id producing each output port.
+    std::vector<uint32_t> outputs;
+    // Per input slot: false when no output depends on it, so the stream feeding it need not be read.
+    std::vector<bool> live_inputs;
+
+    // Number of arithmetic nodes left after optimization.
+    size_t arithmetic_ops() const;
+};
+
+struct Options {
+    // With everything off the DAG mirrors the source one-to-one (no CSE either), for comparing against the optimizer.
+    bool fold_constants = true;
+    bool eliminate_common_subexpressions = true;
+    bool reduce_strength = true;
+};
+
+// Parses and optimizes `source`. `inputs` names the input value slots and `outputs` the output ports; an input may
+// also be referred to positionally as in0, in1, .... An empty source copies in0 to every output.
+// Throws std::invalid_argument on syntax errors, unknown names and unassigned outputs.
+Program compile(
+    const std::string &source,
+    const std::vector<std::string> &inputs,
+    const std::vector<std::string> &outputs,
+    const Options &options = {});
+
+// Inlines `producer` into `consumer`, with consumer input slot `slot` reading producer output `port`. The result keeps
+// the intermediate in registers: its inputs are the producer's inputs followed by the consumer's other inputs (in
+// order), its outputs are the consumer's outputs. The combined DAG is re-optimized across the kernel boundary.
+Program fuse(
+    const Program &producer, uint32_t port, const Program &consumer, uint32_t slot, const Options &options = {});
+
+// Line-oriented text form of a Program, exact for constants, for caching compiled kernels on disk.
+std::string serialize(const Program &program);
+// Inverse of serialize(). Throws std::invalid_argument on malformed or inconsistent text.
+Program deserialize(const std::string &text);
+
+// Tile operations available to a compute kernel. Inputs arrive in circular buffers, everything else lives in dest
+// registers; FPU binary ops read two CBs directly, SFPU ops work in place on dest.
+enum class TileOpKind : uint8_t {
+    CopyTile,    // copy_tile(cb, dst)
+    CopyDest,    // dst <- dst (a value still needed is about to be overwritten in place)
+    FillTile,    // fill_tile(dst, scalar)
+    FpuBinary,   // add_tiles / sub_tiles / mul_tiles(cb_a, cb_b) -> dst
+    SfpuBinary,  // add_binary_tile / sub_binary_tile / mul_binary_tile / div_binary_tile(dst, src)
+    SfpuScalar,  // add_unary_tile / mul_unary_tile / rsub_unary_tile(dst, scalar)
+    SfpuNeg,     // negative_tile(dst)
+    PackTile,    // pack_tile(dst, cb_out)
+};
+
+struct TileOp {
+    TileOpKind kind;
+    Op op = Op::Add;    // Arithmetic op for binary / scalar kinds.
+    uint32_t dst = 0;   // Dest register written (or packed for PackTile).
+    uint32_t src = 0;   // Second dest register for SfpuBinary / CopyDest.
+    uint32_t cb_a = 0;  // Input slot (CopyTile, FpuBinary) or output port (PackTile).
+    uint32_t cb_b = 0;
+    float scalar = 0.0F;
+    bool reversed = false;  // SfpuScalar: scalar is the left operand (c - x).
+};
+
+struct OpCounts {
+    size_t copies = 0;  // CopyTile + CopyDest + FillTile
+    size_t fpu = 0;
+    size_t sfpu = 0;
+    size_t packs = 0;
+
+    size_t total() const { return copies + fpu + sfpu + packs; }
+};
+
+struct Schedule {
+    std::vector<TileOp> ops;
+    uint32_t dest_registers = 0;  // Peak number of dest tiles in use.
+
+    OpCounts counts() const;
+    // Body of the per-tile compute loop, using cb_in<slot> / cb_out<port> as CB names.
+    std::string render() const;
+};
+
+// Number of dest tiles available to one math iteration.
+constexpr uint32_t MAX_DEST_REGISTERS = 8;
+
+// Schedules `program` onto tile ops, reusing dest registers as values die.
+// Throws std::runtime_error if more than MAX_DEST_REGISTERS values are live at once.
+Schedule schedule(const Program &program);
+
+}  // namespace current::host::expr
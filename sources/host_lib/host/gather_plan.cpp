@@ -0,0 +1,62 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "gather_plan.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "thread_pool.hpp"
+
+namespace current::host {
+
+GatherLocality measure_locality(const std::vector<uint32_t> &index_vec, const DramGeometry &geometry) {
+    GatherLocality locality;
+    locality.reads = index_vec.size();
+    locality.chunk_fetches = index_vec.empty() ? 0 : 1;
+    for (size_t i = 1; i < index_vec.size(); i++) {
+        locality.page_switches += geometry.page_of(index_vec[i]) != geometry.page_of(index_vec[i - 1]) ? 1 : 0;
+        locality.bank_switches += geometry.bank_of(index_vec[i]) != geometry.bank_of(index_vec[i - 1]) ? 1 : 0;
+        locality.chunk_fetches += geometry.chunk_of(index_vec[i]) != geometry.chunk_of(index_vec[i - 1]) ? 1 : 0;
+    }
+    return locality;
+}
+
+GatherPlan plan_gather(
+    const std::vector<uint32_t> &index_vec, uint8_t accesses_per_token, const DramGeometry &geometry) {
+    if (accesses_per_token == 0 || index_vec.size() % accesses_per_token != 0) {
+        throw std::invalid_argument("plan_gather: accesses per token must evenly divide the index vector");
+    }
+    size_t tile_reads = size_t{GatherPlan::TILE_TOKENS} * accesses_per_token;
+    size_t num_tiles = (index_vec.size() + tile_reads - 1) / tile_reads;
+
+    GatherPlan plan;
+    plan.indices.resize(index_vec.size());
+    plan.read_offsets.resize(index_vec.size());
+    ThreadPool::global().parallel_for(num_tiles, 1, [&](size_t tile_begin, size_t tile_end) {
+        // Sort (bank << 32 | index, offset) pairs: pages grow with the index, so this orders by (bank, page, index)
+        // and keeps equal indices in their original order.
+        std::vector<std::pair<uint64_t, uint32_t>> order;
+        for (size_t tile = tile_begin; tile < tile_end; tile++) {
+            size_t first = tile * tile_reads;
+            size_t n = std::min(tile_reads, index_vec.size() - first);
+            order.resize(n);
+            for (size_t offset = 0; offset < n; offset++) {
+                uint32_t index = index_vec[first + offset];
+                order[offset] = {uint64_t{geometry.bank_of(index)} << 32 | index, static_cast<uint32_t>(offset)};
+            }
+            std::sort(order.begin(), order.end());
+            for (size_t slot = 0; slot < n; slot++) {
+                plan.read_offsets[first + slot] = order[slot].second;
+                plan.indices[first + slot] = index_vec[first + order[slot].second];
+            }
+        }
+    });
+    plan.before = measure_locality(index_vec, geometry);
+    plan.after = measure_locality(plan.indices, geometry);
+    return plan;
+}
+
+}  // namespace current::host
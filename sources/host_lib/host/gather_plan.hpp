@@ -0,0 +1,61 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace current::host {
+
+// How an interleaved DRAM buffer spreads a gather table: consecutive pages go to consecutive banks. The table is
+// packed (elements back to back); since DRAM reads must be `chunk_size`-aligned, a reader fetches the aligned chunk
+// holding an element and picks the element out of it in L1, reusing the chunk while consecutive reads stay in it.
+struct DramGeometry {
+    uint32_t num_banks = 12;    // Wormhole DRAM channels.
+    uint32_t page_size = 2048;  // Bytes; one bf16 tile.
+    uint32_t element_size = 2;  // Bytes per table element.
+    uint32_t chunk_size = 32;   // Bytes; DRAM read alignment.
+
+    uint32_t page_of(uint32_t index) const { return static_cast<uint32_t>(uint64_t{index} * element_size / page_size); }
+    uint32_t bank_of(uint32_t index) const { return page_of(index) % num_banks; }
+    uint64_t chunk_of(uint32_t index) const { return uint64_t{index} * element_size / chunk_size; }
+
+    // Bytes a table of `elements` takes packed, and in the one-chunk-per-element layout packing replaces.
+    uint64_t packed_bytes(uint64_t elements) const {
+        return (elements * element_size + chunk_size - 1) / chunk_size * chunk_size;
+    }
+    uint64_t padded_bytes(uint64_t elements) const { return elements * chunk_size; }
+};
+
+// Access-locality figures for a read order: how often consecutive reads leave the page / bank of the previous one, and
+// how many chunk fetches a packed-table reader issues (the first read, then every read outside the previous chunk).
+struct GatherLocality {
+    size_t reads = 0;
+    size_t page_switches = 0;
+    size_t bank_switches = 0;
+    size_t chunk_fetches = 0;
+};
+
+// Gather reads reordered for DRAM locality. Reads are permuted only within their own tile of TILE_TOKENS tokens and
+// sorted by (bank, page, index), so one tile's reads walk each bank page by page. Read slot p of a tile fetches
+// indices[p] and belongs at read position read_offsets[p] of that tile (token = offset / accesses_per_token, access =
+// offset % accesses_per_token); the reader scatters it there, so everything downstream sees the original order.
+struct GatherPlan {
+    static constexpr uint32_t TILE_TOKENS = 1024;
+
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> read_offsets;
+    GatherLocality before;
+    GatherLocality after;
+};
+
+GatherLocality measure_locality(const std::vector<uint32_t> &index_vec, const DramGeometry &geometry);
+
+// Throws std::invalid_argument if accesses_per_token is 0 or doesn't divide the index vector.
+GatherPlan plan_gather(
+    const std::vector<uint32_t> &index_vec, uint8_t accesses_per_token, const DramGeometry &geometry);
+
+}  // namespace current::host
@@ -0,0 +1,128 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "kernel_cache.hpp"
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+namespace current::host {
+
+namespace fs = std::filesystem;
+
+void CacheKey::mix(const void *data, size_t size) {
+    // Two independent 64-bit FNV-1a style lanes; a cache collision needs both to collide.
+    const auto *bytes = static_cast<const unsigned char *>(data);
+    for (size_t i = 0; i < size; i++) {
+        lo = (lo ^ bytes[i]) * 0x100000001b3ULL;
+        hi = (hi ^ bytes[i]) * 0x9e3779b97f4a7c15ULL;
+        hi ^= hi >> 29;
+    }
+}
+
+CacheKey &CacheKey::add(std::string_view field) {
+    uint64_t size = field.size();
+    mix(&size, sizeof(size));
+    mix(field.data(), field.size());
+    return *this;
+}
+
+CacheKey &CacheKey::add(uint64_t value) {
+    uint64_t size = sizeof(value);
+    mix(&size, sizeof(size));
+    mix(&value, sizeof(value));
+    return *this;
+}
+
+std::string CacheKey::hex() const {
+    char buf[33];
+    std::snprintf(
+        buf, sizeof(buf), "%016llx%016llx", static_cast<unsigned long long>(hi), static_cast<unsigned long long>(lo));
+    return buf;
+}
+
+KernelCache::KernelCache(fs::path root) : root(std::move(root)) {}
+
+fs::path KernelCache::default_directory() {
+    if (const char *dir = std::getenv("CURRENT_KERNEL_CACHE"); dir != nullptr && *dir != '\0') {
+        return dir;
+    }
+    const char *home = std::getenv("HOME");
+    return fs::path(home != nullptr ? home : fs::temp_directory_path().string()) / ".cache" / "current" / "kernels";
+}
+
+std::optional<CacheEntry> KernelCache::lookup(const CacheKey &key) {
+    auto dir = root / key.hex();
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) {
+        miss_count++;
+        return std::nullopt;
+    }
+    CacheEntry entry;
+    bool ok = true;
+    fs::recursive_directory_iterator it(dir, ec);
+    for (; ok && !ec && it != fs::recursive_directory_iterator(); it.increment(ec)) {
+        if (!it->is_regular_file(ec)) {
+            continue;
+        }
+        auto size = fs::file_size(it->path(), ec);
+        std::ifstream in(it->path(), std::ios::binary);
+        std::string contents(ec ? 0 : size, '\0');
+        in.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+        ok = !ec && in && in.gcount() == static_cast<std::streamsize>(size);
+        entry.files[fs::relative(it->path(), dir).generic_string()] = std::move(contents);
+    }
+    if (!ok || ec) {
+        miss_count++;
+        return std::nullopt;
+    }
+    hit_count++;
+    return entry;
+}
+
+void KernelCache::store(const CacheKey &key, const CacheEntry &entry) {
+    auto dir = root / key.hex();
+    std::ostringstream scratch_name;
+    scratch_name << key.hex() << ".tmp." << getpid() << "." << std::this_thread::get_id();
+    auto scratch = root / scratch_name.str();
+
+    std::error_code ec;
+    fs::create_directories(scratch, ec);
+    if (ec) {
+        throw std::runtime_error("KernelCache: cannot create " + scratch.string() + ": " + ec.message());
+    }
+    for (const auto &[name, contents] : entry.files) {
+        auto path = scratch / name;
+        fs::create_directories(path.parent_path(), ec);
+        std::ofstream out(path, std::ios::binary);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+        if (!out) {
+            fs::remove_all(scratch, ec);
+            throw std::runtime_error("KernelCache: cannot write " + path.string());
+        }
+    }
+    // Never touch a live entry: if another process stored the same key first, the rename fails (the target is a
+    // non-empty directory) and its entry, which is equivalent, stays.
+    fs::rename(scratch, dir, ec);
+    if (ec) {
+        fs::remove_all(scratch, ec);
+    }
+}
+
+CacheEntry KernelCache::get_or_build(const CacheKey &key, const std::function<CacheEntry()> &build) {
+    if (auto entry = lookup(key)) {
+        return *entry;
+    }
+    auto entry = build();
+    store(key, entry);
+    return entry;
+}
+
+}  // namespace current::host
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace current::host {
+
+// 128-bit digest over everything that determines a set of generated kernels: graph topology, port data formats,
+// tiles_per_cb, parallelization factor, expression text. Fields are length-prefixed, so ("ab", "c") != ("a", "bc").
+class CacheKey {
+   public:
+    CacheKey &add(std::string_view field);
+    CacheKey &add(uint64_t value);
+
+    // 32 hex digits; used as the cache directory name.
+    std::string hex() const;
+
+   private:
+    void mix(const void *data, size_t size);
+
+    uint64_t lo = 0xcbf29ce484222325ULL;
+    uint64_t hi = 0x84222325cbf29ce4ULL;
+};
+
+// Files making up one cached entry, by relative path. CpuMap stores each stage's serialized IR and rendered compute
+// loop; device binaries are left to tt_metal's own build cache.
+struct CacheEntry {
+    std::map<std::string, std::string> files;
+};
+
+// Content-addressed on-disk store: <root>/<key hex>/<file>. Entries are written to a scratch directory and renamed
+// into place, and never modified or removed once there, so concurrent processes never observe a half-written entry.
+// Safe to share between threads.
+class KernelCache {
+   public:
+    explicit KernelCache(std::filesystem::path root = default_directory());
+
+    // Counts a hit or a miss; an entry that cannot be read back counts as a miss.
+    std::optional<CacheEntry> lookup(const CacheKey &key);
+    // Keeps an existing entry for `key`, which holds the same contents. Throws std::runtime_error if the cache
+    // directory is not writable.
+    void store(const CacheKey &key, const CacheEntry &entry);
+    // lookup(), falling back to build() + store() on a miss.
+    CacheEntry get_or_build(const CacheKey &key, const std::function<CacheEntry()> &build);
+
+    const std::filesystem::path &directory() const { return root; }
+    size_t hits() const { return hit_count; }
+    size_t misses() const { return miss_count; }
+
+    // $CURRENT_KERNEL_CACHE if set, else $HOME/.cache/current/kernels.
+    static std::filesystem::path default_directory();
+
+   private:
+    std::filesystem::path root;
+    std::atomic<size_t> hit_count = 0;
+    std::atomic<size_t> miss_count = 0;
+};
+
+}  // namespace current::host
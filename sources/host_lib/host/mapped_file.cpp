@@ -0,0 +1,140 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "mapped_file.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace current::host {
+
+namespace {
+
+constexpr uint64_t PAGE = 4096;
+
+uint64_t words_for(DataFormat format, uint64_t count) {
+    // count / 2 + count % 2 rather than (count + 1) / 2, which wraps for a count read from a corrupt header.
+    return format == DataFormat::Float16_b ? count / 2 + count % 2 : count;
+}
+
+[[noreturn]] void fail(const std::filesystem::path &path, const std::string &what) {
+    throw std::runtime_error("MappedFile: " + path.string() + ": " + what);
+}
+
+// Closes the descriptor once the mapping exists (or on error).
+struct Fd {
+    int fd;
+    ~Fd() {
+        if (fd >= 0) {
+            close(fd);
+        }
+    }
+};
+
+}  // namespace
+
+MappedFile MappedFile::create(const std::filesystem::path &path, DataFormat format, uint64_t count, Layout layout) {
+    StreamFileHeader header;
+    header.format = format;
+    header.layout = layout;
+    header.count = count;
+    header.data_offset = (sizeof(StreamFileHeader) + PAGE - 1) / PAGE * PAGE;
+    size_t length = header.data_offset + words_for(format, count) * sizeof(uint32_t);
+
+    Fd file{::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+    if (file.fd < 0) {
+        fail(path, std::strerror(errno));
+    }
+    if (ftruncate(file.fd, static_cast<off_t>(length)) != 0) {
+        fail(path, std::strerror(errno));
+    }
+    void *base = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, file.fd, 0);
+    if (base == MAP_FAILED) {
+        fail(path, std::strerror(errno));
+    }
+    std::memcpy(base, &header, sizeof(header));
+    return MappedFile(base, length, true);
+}
+
+MappedFile MappedFile::open(const std::filesystem::path &path, bool writable, Access access) {
+    Fd file{::open(path.c_str(), writable ? O_RDWR : O_RDONLY)};
+    if (file.fd < 0) {
+        fail(path, std::strerror(errno));
+    }
+    struct stat st {};
+    if (fstat(file.fd, &st) != 0) {
+        fail(path, std::strerror(errno));
+    }
+    auto length = static_cast<size_t>(st.st_size);
+    if (length < sizeof(StreamFileHeader)) {
+        fail(path, "not a stream file");
+    }
+    void *base = mmap(nullptr, length, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file.fd, 0);
+    if (base == MAP_FAILED) {
+        fail(path, std::strerror(errno));
+    }
+    MappedFile mapped(base, length, writable);
+    const auto &header = mapped.header();
+    if (header.magic != StreamFileHeader::MAGIC || header.version != StreamFileHeader::VERSION) {
+        fail(path, "not a stream file");
+    }
+    if (header.format != DataFormat::Float16_b && header.format != DataFormat::UInt32) {
+        fail(path, "unknown data format");
+    }
+    if (header.layout != Layout::RowMajor) {
+        fail(path, "unknown layout");
+    }
+    // Compare against the bytes left after data_offset, so no crafted header can overflow the sum.
+    if (header.data_offset % sizeof(uint32_t) != 0 || header.data_offset > length ||
+        words_for(header.format, header.count) > (length - header.data_offset) / sizeof(uint32_t)) {
+        fail(path, "truncated");
+    }
+    mapped.advise(access);
+    return mapped;
+}
+
+MappedFile::MappedFile(MappedFile &&other) noexcept :
+    base(std::exchange(other.base, nullptr)), length(std::exchange(other.length, 0)), rw(other.rw) {}
+
+MappedFile &MappedFile::operator=(MappedFile &&other) noexcept {
+    if (this != &other) {
+        if (base != nullptr) {
+            munmap(base, length);
+        }
+        base = std::exchange(other.base, nullptr);
+        length = std::exchange(other.length, 0);
+        rw = other.rw;
+    }
+    return *this;
+}
+
+MappedFile::~MappedFile() {
+    if (base != nullptr) {
+        munmap(base, length);
+    }
+}
+
+size_t MappedFile::num_words() const { return words_for(header().format, header().count); }
+
+void MappedFile::advise(Access access) {
+    if (base != nullptr) {
+        madvise(base, length, access == Access::Random ? MADV_RANDOM : MADV_SEQUENTIAL);
+    }
+}
+
+void MappedFile::sync() {
+    if (base != nullptr && rw) {
+        msync(base, length, MS_SYNC);
+    }
+}
+
+}  // namespace current::host
@@ -0,0 +1,82 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace current::host {
+
+enum class DataFormat : uint32_t {
+    Float16_b = 0,  // bf16 packed two per word, element 2i in the low half.
+    UInt32 = 1,     // One element per word (gather indices).
+};
+
+enum class Layout : uint32_t {
+    RowMajor = 0,  // Elements in stream order.
+};
+
+// How a mapping will be read, passed to the kernel as madvise() advice.
+enum class Access {
+    Sequential,  // Streams, consumed front to back: read ahead aggressively.
+    Random,      // Gather tables and stencil images: read ahead would fetch pages no index touches.
+};
+
+// Fixed-size header at the start of a stream file. The packed data starts at data_offset, a page boundary, so the
+// mapping of the data is page aligned.
+struct StreamFileHeader {
+    static constexpr uint64_t MAGIC = 0x4d5254534e525543ULL;  // "CURNSTRM"
+    static constexpr uint32_t VERSION = 1;
+
+    uint64_t magic = MAGIC;
+    uint32_t version = VERSION;
+    DataFormat format = DataFormat::Float16_b;
+    Layout layout = Layout::RowMajor;
+    uint32_t reserved = 0;
+    uint64_t count = 0;        // Elements.
+    uint64_t data_offset = 0;  // Bytes from the start of the file.
+};
+
+// A stream file mapped into memory. Streams built on it read from and write to the mapping directly, so a dataset is
+// never copied into a host vector. Move-only; unmaps on destruction.
+class MappedFile {
+   public:
+    // Creates (or truncates) `path`, sized for `count` elements, and maps it read-write. The data is zero filled.
+    static MappedFile create(
+        const std::filesystem::path &path, DataFormat format, uint64_t count, Layout layout = Layout::RowMajor);
+    // Maps an existing stream file, read-only unless `writable`, advising the kernel of the `access` pattern.
+    // Throws std::runtime_error if the file can't be opened or isn't a complete stream file.
+    static MappedFile open(
+        const std::filesystem::path &path, bool writable = false, Access access = Access::Sequential);
+
+    MappedFile(MappedFile &&other) noexcept;
+    MappedFile &operator=(MappedFile &&other) noexcept;
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+    ~MappedFile();
+
+    const StreamFileHeader &header() const { return *static_cast<const StreamFileHeader *>(base); }
+    uint32_t *words() { return reinterpret_cast<uint32_t *>(static_cast<char *>(base) + header().data_offset); }
+    const uint32_t *words() const {
+        return reinterpret_cast<const uint32_t *>(static_cast<const char *>(base) + header().data_offset);
+    }
+    size_t num_words() const;
+    bool writable() const { return rw; }
+
+    // Writes dirty pages back to the file (msync).
+    void sync();
+    // Replaces the access advice given at open() / create(); GatherStream marks its table Random.
+    void advise(Access access);
+
+   private:
+    MappedFile(void *base, size_t length, bool rw) : base(base), length(length), rw(rw) {}
+
+    void *base = nullptr;
+    size_t length = 0;
+    bool rw = false;
+};
+
+}  // namespace current::host
@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "microbench.hpp"
+
+#include <stdexcept>
+
+namespace current::host {
+
+std::vector<MicroBenchmark> microbenchmark_registry() {
+    std::vector<MicroBenchmark> registry = {
+        {.name = "empty", .snippet = "EMPTY"},
+        {.name = "branch_predictable", .snippet = "BRANCH_PREDICTABLE"},
+        {.name = "xorshift", .snippet = "XORSHIFT"},
+        {.name = "branch_unpredictable", .snippet = "BRANCH_UNPREDICTABLE"},
+        {.name = "l1_load", .snippet = "L1_LOAD"},
+        {.name = "l1_store", .snippet = "L1_STORE"},
+    };
+    for (uint32_t bytes : {32U, 256U, 2048U, 8192U}) {
+        auto size = std::to_string(bytes);
+        registry.push_back({.name = "noc_read_" + size, .snippet = "NOC_READ", .bytes = bytes, .data_movement = true});
+        registry.push_back(
+            {.name = "noc_write_" + size, .snippet = "NOC_WRITE", .bytes = bytes, .data_movement = true});
+    }
+    registry.push_back({.name = "cb_push_pop", .snippet = "CB_PUSH_POP", .data_movement = true});
+    return registry;
+}
+
+std::map<std::string, std::string> microbenchmark_defines(const MicroBenchmark &benchmark) {
+    std::map<std::string, std::string> defines = {{"BENCH_" + benchmark.snippet, "1"}};
+    if (benchmark.bytes != 0) {
+        defines["BENCH_BYTES"] = std::to_string(benchmark.bytes);
+    }
+    return defines;
+}
+
+std::vector<uint64_t> decode_cycles(const std::vector<uint32_t> &words) {
+    if (words.size() != 2 * MICROBENCH_NUM_RISCS) {
+        throw std::invalid_argument("decode_cycles: expected " + std::to_string(2 * MICROBENCH_NUM_RISCS) + " words");
+    }
+    std::vector<uint64_t> cycles;
+    for (uint32_t risc = 0; risc < MICROBENCH_NUM_RISCS; risc++) {
+        cycles.push_back(uint64_t{words[2 * risc + 1]} << 32 | words[2 * risc]);
+    }
+    return cycles;
+}
+
+double cycles_per_op(uint64_t cycles, uint64_t baseline_cycles, uint32_t iterations) {
+    if (iterations == 0) {
+        throw std::invalid_argument("cycles_per_op: no iterations");
+    }
+    if (cycles <= baseline_cycles) {
+        return 0.0;
+    }
+    return static_cast<double>(cycles - baseline_cycles) / iterations;
+}
+
+}  // namespace current::host
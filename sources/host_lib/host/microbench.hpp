@@ -0,0 +1,41 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace current::host {
+
+// A kernel snippet the microbench example times: the kernels compile in the one selected by BENCH_<snippet> and run
+// it in a loop, reading the wall-clock cycle counter around the loop.
+struct MicroBenchmark {
+    std::string name;            // Reported name, e.g. "noc_read_2048".
+    std::string snippet;         // Snippet define without the BENCH_ prefix, e.g. "NOC_READ".
+    uint32_t bytes = 0;          // Transfer size of NoC snippets, passed as BENCH_BYTES.
+    bool data_movement = false;  // Needs a data movement RISC (NoC, CBs); otherwise it also runs on the TRISCs.
+};
+
+// Every snippet the kernels implement. The first is the empty loop whose cycles are subtracted from the others.
+// "branch_unpredictable" branches on an xorshift generator, so compare it against "xorshift" rather than the baseline.
+std::vector<MicroBenchmark> microbenchmark_registry();
+
+std::map<std::string, std::string> microbenchmark_defines(const MicroBenchmark &benchmark);
+
+// RISCs in the order of the kernels' result slots.
+constexpr const char *MICROBENCH_RISCS[] = {"BRISC", "NCRISC", "TRISC0", "TRISC1", "TRISC2"};
+constexpr uint32_t MICROBENCH_NUM_RISCS = 5;
+
+// Cycle counts as the kernels store them in L1: a (low, high) word pair per RISC slot. Throws std::invalid_argument
+// unless there are exactly MICROBENCH_NUM_RISCS pairs.
+std::vector<uint64_t> decode_cycles(const std::vector<uint32_t> &words);
+
+// (cycles - baseline_cycles) / iterations, clamped at 0 when the snippet measured faster than the empty loop (noise
+// on a snippet the compiler reduced to nothing). Throws std::invalid_argument for 0 iterations.
+double cycles_per_op(uint64_t cycles, uint64_t baseline_cycles, uint32_t iterations);
+
+}  // namespace current::host
@@ -0,0 +1,112 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "roofline.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <sstream>
+#include <stdexcept>
+
+namespace current::host {
+
+namespace {
+
+const char *resource_name(Resource resource) {
+    switch (resource) {
+        case Resource::DramBank: return "DRAM";
+        case Resource::NocLink: return "NoC";
+        case Resource::Reader: return "reader RISC";
+        case Resource::Compute: return "compute";
+    }
+    return "";
+}
+
+std::string core_name(const char *what, const CoreLoad &core) {
+    return std::string(what) + " (" + std::to_string(core.x) + ", " + std::to_string(core.y) + ")";
+}
+
+}  // namespace
+
+uint64_t Traffic::dram_bytes() const {
+    uint64_t bytes = 0;
+    for (uint64_t bank : dram_bank_bytes) {
+        bytes += bank;
+    }
+    return bytes;
+}
+
+RooflineReport roofline(const Traffic &traffic, double measured_seconds, const DevicePeaks &peaks) {
+    if (!(measured_seconds > 0.0)) {
+        throw std::invalid_argument("roofline: measured time must be positive");
+    }
+    RooflineReport report;
+    report.measured_seconds = measured_seconds;
+
+    auto busiest = [&](Resource resource) {
+        ResourceUse use;
+        use.resource = resource;
+        auto consider = [&](double seconds, std::string name) {
+            if (use.name.empty() || seconds > use.seconds) {
+                use.seconds = seconds;
+                use.name = std::move(name);
+            }
+        };
+        if (resource == Resource::DramBank) {
+            for (size_t bank = 0; bank < traffic.dram_bank_bytes.size(); bank++) {
+                consider(
+                    static_cast<double>(traffic.dram_bank_bytes[bank]) / peaks.dram_bank_bandwidth,
+                    "DRAM bank " + std::to_string(bank));
+            }
+        }
+        for (const auto &core : traffic.cores) {
+            if (resource == Resource::NocLink) {
+                consider(static_cast<double>(core.noc_bytes) / peaks.noc_link_bandwidth, core_name("NoC link", core));
+            } else if (resource == Resource::Reader) {
+                consider(
+                    static_cast<double>(core.accesses) * peaks.cycles_per_access / peaks.clock,
+                    core_name("reader", core));
+            } else if (resource == Resource::Compute) {
+                const auto &ops = core.tile_ops;
+                double cycles = static_cast<double>(ops.copies + ops.packs) * peaks.cycles_per_move_tile +
+                                static_cast<double>(ops.fpu) * peaks.cycles_per_fpu_tile +
+                                static_cast<double>(ops.sfpu) * peaks.cycles_per_sfpu_tile;
+                consider(cycles / peaks.clock, core_name("compute", core));
+            }
+        }
+        if (use.name.empty()) {
+            use.name = std::string(resource_name(resource)) + " (unused)";
+        }
+        use.utilization = use.seconds / measured_seconds;
+        return use;
+    };
+
+    for (auto resource : {Resource::DramBank, Resource::NocLink, Resource::Reader, Resource::Compute}) {
+        report.resources.push_back(busiest(resource));
+    }
+    report.binding = *std::max_element(
+        report.resources.begin(), report.resources.end(), [](const ResourceUse &a, const ResourceUse &b) {
+            return a.seconds < b.seconds;
+        });
+    report.achieved_dram_bandwidth = static_cast<double>(traffic.dram_bytes()) / measured_seconds;
+    report.peak_dram_bandwidth = peaks.dram_bank_bandwidth * static_cast<double>(traffic.dram_bank_bytes.size());
+    return report;
+}
+
+std::string RooflineReport::describe() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3);
+    out << "measured " << measured_seconds * 1e3 << " ms\n";
+    for (const auto &use : resources) {
+        out << (use.resource == binding.resource ? "* " : "  ") << std::setw(12) << std::left
+            << resource_name(use.resource) << std::right << std::setw(12) << use.seconds * 1e3 << " ms at peak "
+            << std::setw(8) << std::setprecision(1) << use.utilization * 100.0 << std::setprecision(3) << "%  "
+            << use.name << "\n";
+    }
+    out << "DRAM " << achieved_dram_bandwidth / 1e9 << " GB/s of " << peak_dram_bandwidth / 1e9
+        << " GB/s peak; bound by " << resource_name(binding.resource) << "\n";
+    return out.str();
+}
+
+}  // namespace current::host
@@ -0,0 +1,77 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "expr.hpp"
+#include "gather_plan.hpp"
+
+namespace current::host {
+
+// What one core does in an execution: bytes through its NoC port, gathered elements its reader RISC picks out one at
+// a time, and the tile ops of its compute kernel.
+struct CoreLoad {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint64_t noc_bytes = 0;
+    uint64_t accesses = 0;
+    expr::OpCounts tile_ops;
+};
+
+// Theoretical traffic of one execution of a graph (see CpuMap::traffic()): bytes per interleaved DRAM bank and the
+// load on every core that runs a stage.
+struct Traffic {
+    std::vector<uint64_t> dram_bank_bytes;
+    std::vector<CoreLoad> cores;
+
+    uint64_t dram_bytes() const;
+};
+
+// Peak rates of the resources an execution can be bound by. Defaults are rough Wormhole n150 figures; the cycle costs
+// are what the microbench example measures.
+struct DevicePeaks {
+    double dram_bank_bandwidth = 24e9;   // Bytes/s per bank (288 GB/s over 12 banks).
+    double noc_link_bandwidth = 28e9;    // Bytes/s through one core's NoC port (32 B/cycle at 1 GHz, minus overhead).
+    double clock = 1e9;                  // Hz.
+    double cycles_per_access = 8.0;      // Reader RISC cycles to pick out one gathered element.
+    double cycles_per_move_tile = 32.0;  // Copies and packs.
+    double cycles_per_fpu_tile = 32.0;
+    double cycles_per_sfpu_tile = 256.0;
+};
+
+enum class Resource {
+    DramBank,
+    NocLink,  // A core's NoC port. Contention on the links between routers is not modeled.
+    Reader,   // A core's data movement RISC, gathering element by element.
+    Compute,  // A core's TRISCs.
+};
+
+// The busiest instance of a resource: how long it needs at peak rate, and what share of the measured time that is.
+struct ResourceUse {
+    Resource resource = Resource::DramBank;
+    std::string name;  // "DRAM bank 3", "NoC link (1, 0)", ...
+    double seconds = 0.0;
+    double utilization = 0.0;  // seconds / measured; above 1 means the peaks are set too low.
+};
+
+struct RooflineReport {
+    double measured_seconds = 0.0;
+    std::vector<ResourceUse> resources;  // One per Resource, in enum order.
+    ResourceUse binding;                 // The resource with the longest time at peak.
+    double achieved_dram_bandwidth = 0.0;  // Bytes/s over the measured time.
+    double peak_dram_bandwidth = 0.0;      // All banks together.
+
+    // One line per resource with the binding one marked, then achieved vs peak DRAM bandwidth.
+    std::string describe() const;
+};
+
+// Compares the traffic of an execution with its measured duration. Pure arithmetic, so synthetic durations work as well
+// as measured ones. Throws std::invalid_argument for a non-positive duration.
+RooflineReport roofline(const Traffic &traffic, double measured_seconds, const DevicePeaks &peaks = {});
+
+}  // namespace current::host
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "scan.hpp"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include "thread_pool.hpp"
+
+namespace current::host {
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 1 << 16;
+
+}  // namespace
+
+std::vector<uint32_t> prefix_sum(const std::vector<uint32_t> &values, ScanKind kind) {
+    std::vector<uint32_t> out(values.size());
+    size_t num_blocks = (values.size() + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    std::vector<uint32_t> carries(num_blocks);
+    auto &pool = ThreadPool::global();
+    pool.parallel_for(num_blocks, 1, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++) {
+            auto first = values.begin() + static_cast<std::ptrdiff_t>(b * BLOCK_SIZE);
+            auto last = values.begin() + static_cast<std::ptrdiff_t>(std::min(values.size(), (b + 1) * BLOCK_SIZE));
+            carries[b] = std::accumulate(first, last, uint32_t{0});
+        }
+    });
+    std::exclusive_scan(carries.begin(), carries.end(), carries.begin(), uint32_t{0});
+    pool.parallel_for(num_blocks, 1, [&](size_t begin, size_t end) {
+        for (size_t b = begin; b < end; b++) {
+            uint32_t running = carries[b];
+            for (size_t i = b * BLOCK_SIZE; i < std::min(values.size(), (b + 1) * BLOCK_SIZE); i++) {
+                if (kind == ScanKind::Exclusive) {
+                    out[i] = running;
+                }
+                running += values[i];
+                if (kind == ScanKind::Inclusive) {
+                    out[i] = running;
+                }
+            }
+        }
+    });
+    return out;
+}
+
+std::vector<uint32_t> csr_offsets(const std::vector<uint32_t> &arities) {
+    uint64_t total = 0;
+    for (uint32_t arity : arities) {
+        total += arity;
+    }
+    if (total > UINT32_MAX) {
+        throw std::overflow_error("csr_offsets: more than 2^32 - 1 indices");
+    }
+    auto offsets = prefix_sum(arities, ScanKind::Exclusive);
+    offsets.push_back(static_cast<uint32_t>(total));
+    return offsets;
+}
+
+}  // namespace current::host
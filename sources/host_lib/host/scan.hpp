@@ -0,0 +1,25 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+namespace current::host {
+
+enum class ScanKind {
+    Inclusive,  // out[i] = in[0] + ... + in[i]
+    Exclusive,  // out[i] = in[0] + ... + in[i - 1]; out[0] = 0
+};
+
+// Integer prefix sum, split across the global thread pool in two passes: every block sums its range, the block totals
+// are scanned into per-block carries, then every block scans its range from its carry. Sums wrap modulo 2^32.
+std::vector<uint32_t> prefix_sum(const std::vector<uint32_t> &values, ScanKind kind = ScanKind::Inclusive);
+
+// CSR offsets for a GatherStream from per-token arities: the exclusive scan plus the total, arities.size() + 1 long.
+// Throws std::overflow_error if the total does not fit 32 bits.
+std::vector<uint32_t> csr_offsets(const std::vector<uint32_t> &arities);
+
+}  // namespace current::host
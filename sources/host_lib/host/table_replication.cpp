@@ -0,0 +1,71 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "table_replication.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+namespace current::host {
+
+std::vector<MulticastRange> multicast_ranges(const WorkSplit &split) {
+    // Column x -> its cores' y coordinates, sorted.
+    std::map<uint32_t, std::vector<uint32_t>> columns;
+    for (const auto &core : split.cores) {
+        columns[core.x].push_back(core.y);
+    }
+    std::vector<MulticastRange> ranges;
+    for (auto &[x, ys] : columns) {
+        std::sort(ys.begin(), ys.end());
+        ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+        for (size_t i = 0; i < ys.size();) {
+            size_t j = i;
+            while (j + 1 < ys.size() && ys[j + 1] == ys[j] + 1) {
+                j++;
+            }
+            // Widen a range from the previous column when this run spans the same rows.
+            auto match = std::find_if(ranges.begin(), ranges.end(), [&](const MulticastRange &range) {
+                return range.x1 + 1 == x && range.y0 == ys[i] && range.y1 == ys[j];
+            });
+            if (match != ranges.end()) {
+                match->x1 = x;
+            } else {
+                ranges.push_back({x, ys[i], x, ys[j]});
+            }
+            i = j + 1;
+        }
+    }
+    return ranges;
+}
+
+std::string ReplicationPlan::describe() const {
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << "replicating " << table_bytes << " bytes to " << num_cores
+        << " cores: per-core " << per_core_seconds * 1e3 << " ms, multicast " << multicast_seconds * 1e3 << " ms ("
+        << ranges.size() << " ranges), saves " << saved_seconds() * 1e3 << " ms";
+    return out.str();
+}
+
+ReplicationPlan plan_replication(uint64_t table_bytes, const WorkSplit &split, const TransferModel &model) {
+    if (split.cores.empty()) {
+        throw std::invalid_argument("plan_replication: split has no cores");
+    }
+    ReplicationPlan plan;
+    plan.table_bytes = table_bytes;
+    plan.source = split.cores.front();
+    plan.ranges = multicast_ranges(split);
+    plan.num_cores = static_cast<uint32_t>(split.cores.size());
+
+    double host_write = model.host_latency + static_cast<double>(table_bytes) / model.host_bandwidth;
+    double multicast = model.noc_latency + static_cast<double>(table_bytes) / model.noc_bandwidth;
+    plan.per_core_seconds = host_write * plan.num_cores;
+    // A multicast reaches every core of its range at once, so the fan-out costs one write per range, not per core.
+    plan.multicast_seconds = plan.num_cores == 1 ? host_write : host_write + multicast * plan.ranges.size();
+    return plan;
+}
+
+}  // namespace current::host
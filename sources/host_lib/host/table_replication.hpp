@@ -0,0 +1,55 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "work_split.hpp"
+
+namespace current::host {
+
+// Cores [x0, x1] x [y0, y1] (inclusive, like tt_metal's CoreRange): what one NoC multicast write reaches.
+struct MulticastRange {
+    uint32_t x0 = 0;
+    uint32_t y0 = 0;
+    uint32_t x1 = 0;
+    uint32_t y1 = 0;
+
+    uint32_t size() const { return (x1 - x0 + 1) * (y1 - y0 + 1); }
+};
+
+// Covers the cores of a split with few rectangles: runs of cores within a column, merged across neighbouring columns
+// with the same run. split_work's column-major order gives at most two: the full columns and the partial last one.
+std::vector<MulticastRange> multicast_ranges(const WorkSplit &split);
+
+// Transfer costs behind a table upload. Defaults are rough Wormhole n150 figures.
+struct TransferModel {
+    double host_bandwidth = 12e9;   // Bytes/s over PCIe.
+    double host_latency = 30e-6;    // Seconds per host write (one per destination core).
+    double noc_bandwidth = 28e9;    // Bytes/s for one multicast write (32 B/cycle at 1 GHz, minus overhead).
+    double noc_latency = 1e-6;      // Seconds to issue a multicast and collect its acks.
+};
+
+// How a gather table reaches every core of a split when each needs its own L1 copy: written from the host once per
+// core, or uploaded once to `source` and fanned out with one NoC multicast per range.
+struct ReplicationPlan {
+    uint64_t table_bytes = 0;
+    CoreWork source = {};
+    std::vector<MulticastRange> ranges;
+    uint32_t num_cores = 0;
+    double per_core_seconds = 0.0;   // num_cores host writes.
+    double multicast_seconds = 0.0;  // One host write plus the multicasts.
+
+    double saved_seconds() const { return per_core_seconds - multicast_seconds; }
+    // "replicating N bytes to C cores: per-core X ms, multicast Y ms (R ranges), saves Z ms".
+    std::string describe() const;
+};
+
+// Throws std::invalid_argument for a split with no cores.
+ReplicationPlan plan_replication(uint64_t table_bytes, const WorkSplit &split, const TransferModel &model = {});
+
+}  // namespace current::host
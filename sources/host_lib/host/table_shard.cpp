@@ -0,0 +1,177 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "table_shard.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+#include "bf16.hpp"
+#include "thread_pool.hpp"
+
+namespace current::host {
+
+namespace {
+
+constexpr uint32_t NOC_ALIGNMENT = 32;  // Bytes.
+
+}  // namespace
+
+ShardLayout plan_shards(uint64_t table_elements, CoreGrid grid, uint32_t budget_bytes, uint32_t element_size) {
+    if (element_size == 0 || NOC_ALIGNMENT % element_size != 0) {
+        throw std::invalid_argument("plan_shards: element size must divide the 32-byte NoC alignment");
+    }
+    if (grid.size() == 0) {
+        throw std::invalid_argument("plan_shards: empty core grid");
+    }
+    if (table_elements > UINT32_MAX) {
+        throw std::invalid_argument("plan_shards: table has more than 2^32 - 1 elements");
+    }
+    uint32_t align = NOC_ALIGNMENT / element_size;
+    uint32_t capacity = budget_bytes / element_size / align * align;
+    if (capacity == 0) {
+        throw std::invalid_argument("plan_shards: L1 budget is smaller than one 32-byte chunk");
+    }
+    uint64_t shards = std::max<uint64_t>(1, (table_elements + capacity - 1) / capacity);
+    if (shards > grid.size()) {
+        throw std::invalid_argument(
+            "plan_shards: table needs " + std::to_string(shards) + " cores of L1 but the grid has " +
+            std::to_string(grid.size()));
+    }
+
+    ShardLayout layout;
+    layout.element_size = element_size;
+    // Spread evenly over that many shards, rounding each up to the alignment; that can leave the last one empty.
+    uint64_t per_shard = (table_elements + shards - 1) / shards;
+    layout.shard_elements = static_cast<uint32_t>(std::max<uint64_t>(align, (per_shard + align - 1) / align * align));
+    uint64_t first = 0;
+    for (uint32_t i = 0; i < shards && (first < table_elements || i == 0); i++) {
+        auto count = static_cast<uint32_t>(std::min<uint64_t>(layout.shard_elements, table_elements - first));
+        layout.shards.push_back({i / grid.y, i % grid.y, static_cast<uint32_t>(first), count});
+        first += count;
+    }
+    return layout;
+}
+
+std::vector<std::vector<uint32_t>> shard_table(const std::vector<uint32_t> &table, const ShardLayout &layout) {
+    if (layout.element_size != 2) {
+        throw std::invalid_argument("shard_table: only bf16 tables are supported");
+    }
+    const auto &last = layout.shards.back();
+    if (table.size() * 2 < uint64_t{last.first} + last.count) {
+        throw std::invalid_argument("shard_table: table is smaller than the layout");
+    }
+    std::vector<std::vector<uint32_t>> shards;
+    for (const auto &shard : layout.shards) {
+        // Shards start on 32-byte boundaries, so on a word.
+        auto begin = table.begin() + shard.first / 2;
+        shards.emplace_back(begin, begin + (shard.count + 1) / 2);
+    }
+    return shards;
+}
+
+GatherRoute route_gather(
+    const std::vector<uint32_t> &index_vec, uint8_t accesses_per_token, const ShardLayout &layout) {
+    if (accesses_per_token == 0 || index_vec.size() % accesses_per_token != 0) {
+        throw std::invalid_argument("route_gather: accesses per token must evenly divide the index vector");
+    }
+    size_t num_shards = layout.shards.size();
+    uint64_t table_end = uint64_t{layout.shards.back().first} + layout.shards.back().count;
+    if (std::any_of(index_vec.begin(), index_vec.end(), [&](uint32_t index) { return index >= table_end; })) {
+        throw std::invalid_argument("route_gather: index outside the sharded table");
+    }
+    size_t tile_reads = size_t{GatherRoute::TILE_TOKENS} * accesses_per_token;
+    size_t num_tiles = (index_vec.size() + tile_reads - 1) / tile_reads;
+
+    GatherRoute route;
+    route.local_indices.resize(index_vec.size());
+    route.read_offsets.resize(index_vec.size());
+    std::vector<std::vector<ShardBatch>> tile_batches(num_tiles);
+    ThreadPool::global().parallel_for(num_tiles, 1, [&](size_t tile_begin, size_t tile_end) {
+        // Counting sort of each tile's reads by owning shard; stable, so a batch keeps the reads' original order.
+        std::vector<uint32_t> starts(num_shards + 1);
+        for (size_t tile = tile_begin; tile < tile_end; tile++) {
+            size_t first = tile * tile_reads;
+            size_t n = std::min(tile_reads, index_vec.size() - first);
+            std::fill(starts.begin(), starts.end(), 0);
+            for (size_t r = 0; r < n; r++) {
+                starts[layout.shard_of(index_vec[first + r]) + 1]++;
+            }
+            for (size_t s = 0; s < num_shards; s++) {
+                if (starts[s + 1] != 0) {
+                    tile_batches[tile].push_back(
+                        {static_cast<uint32_t>(s), static_cast<uint32_t>(first + starts[s]), starts[s + 1]});
+                }
+                starts[s + 1] += starts[s];
+            }
+            for (size_t r = 0; r < n; r++) {
+                uint32_t index = index_vec[first + r];
+                size_t slot = first + starts[layout.shard_of(index)]++;
+                route.local_indices[slot] = layout.local_of(index);
+                route.read_offsets[slot] = static_cast<uint32_t>(r);
+            }
+        }
+    });
+    route.tile_batches.push_back(0);
+    for (auto &batches : tile_batches) {
+        route.batches.insert(route.batches.end(), batches.begin(), batches.end());
+        route.tile_batches.push_back(route.batches.size());
+    }
+    return route;
+}
+
+std::vector<uint32_t> gather_routed(
+    const std::vector<std::vector<uint32_t>> &shards, const GatherRoute &route, uint8_t accesses_per_token) {
+    size_t tile_reads = size_t{GatherRoute::TILE_TOKENS} * accesses_per_token;
+    std::vector<uint16_t> values(route.local_indices.size());
+    ThreadPool::global().parallel_for(route.tile_batches.size() - 1, 1, [&](size_t tile_begin, size_t tile_end) {
+        for (size_t tile = tile_begin; tile < tile_end; tile++) {
+            size_t first = tile * tile_reads;
+            for (size_t b = route.tile_batches[tile]; b < route.tile_batches[tile + 1]; b++) {
+                const auto &batch = route.batches[b];
+                const auto &shard = shards.at(batch.shard);
+                for (size_t slot = batch.begin; slot < batch.begin + batch.count; slot++) {
+                    values[first + route.read_offsets[slot]] = packed_bf16_at(shard.data(), route.local_indices[slot]);
+                }
+            }
+        }
+    });
+    std::vector<uint32_t> packed((values.size() + 1) / 2, 0);
+    for (size_t i = 0; i < values.size(); i++) {
+        packed[i / 2] |= static_cast<uint32_t>(values[i]) << (16 * (i & 1));
+    }
+    return packed;
+}
+
+PackedRoute pack_route(const GatherRoute &route, const ShardLayout &layout) {
+    if (layout.shard_elements > PackedRoute::LOCAL_MASK + 1) {
+        throw std::invalid_argument("pack_route: shards are too large for a packed local index");
+    }
+    constexpr uint32_t max_offset = (1U << (32 - PackedRoute::LOCAL_BITS)) - 1;
+    if (std::any_of(route.read_offsets.begin(), route.read_offsets.end(), [](uint32_t offset) {
+            return offset > max_offset;
+        })) {
+        throw std::invalid_argument("pack_route: tiles have more reads than a packed read offset can address");
+    }
+    constexpr uint32_t words_per_read = NOC_ALIGNMENT / sizeof(uint32_t);
+    auto num_shards = static_cast<uint32_t>(layout.shards.size());
+
+    PackedRoute packed;
+    packed.counts_stride = (num_shards + words_per_read - 1) / words_per_read * words_per_read;
+    packed.reads.resize(route.local_indices.size());
+    for (size_t slot = 0; slot < packed.reads.size(); slot++) {
+        packed.reads[slot] = route.read_offsets[slot] << PackedRoute::LOCAL_BITS | route.local_indices[slot];
+    }
+    size_t num_tiles = route.tile_batches.size() - 1;
+    packed.counts.assign(num_tiles * packed.counts_stride, 0);
+    for (size_t tile = 0; tile < num_tiles; tile++) {
+        for (size_t b = route.tile_batches[tile]; b < route.tile_batches[tile + 1]; b++) {
+            packed.counts[tile * packed.counts_stride + route.batches[b].shard] = route.batches[b].count;
+        }
+    }
+    return packed;
+}
+
+}  // namespace current::host
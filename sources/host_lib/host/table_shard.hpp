@@ -0,0 +1,96 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "work_split.hpp"
+
+namespace current::host {
+
+// L1 a core can give a table shard: Wormhole's 1464 KiB minus the firmware-reserved base, circular buffers and stack.
+constexpr uint32_t DEFAULT_SHARD_BUDGET = 1024 * 1024;
+
+// One core's slice of a gather table: elements [first, first + count).
+struct TableShard {
+    uint32_t x = 0;
+    uint32_t y = 0;
+    uint32_t first = 0;
+    uint32_t count = 0;
+};
+
+// A gather table split into contiguous, equally sized shards, one per core, so that the owner of an index is a
+// division away. Shards are assigned to cores in the same column-major order as split_work.
+struct ShardLayout {
+    uint32_t shard_elements = 0;
+    uint32_t element_size = 2;
+    std::vector<TableShard> shards;
+
+    uint32_t shard_of(uint32_t index) const { return index / shard_elements; }
+    uint32_t local_of(uint32_t index) const { return index % shard_elements; }
+};
+
+// Picks the fewest shards whose L1 slices hold the table, each a multiple of 32 bytes (the NoC read alignment). A
+// table that fits one core gets a single shard. Throws std::invalid_argument if even the whole grid cannot hold it;
+// such a table belongs in DRAM.
+ShardLayout plan_shards(
+    uint64_t table_elements,
+    CoreGrid grid = {},
+    uint32_t budget_bytes = DEFAULT_SHARD_BUDGET,
+    uint32_t element_size = 2);
+
+// Packed bf16 contents of each shard, in layout order: what gets written to each core's L1.
+std::vector<std::vector<uint32_t>> shard_table(const std::vector<uint32_t> &table, const ShardLayout &layout);
+
+// One batched remote read: reads [begin, begin + count) of GatherRoute::local_indices all go to `shard`.
+struct ShardBatch {
+    uint32_t shard = 0;
+    uint32_t begin = 0;
+    uint32_t count = 0;
+};
+
+// Gather reads routed to the shards that own them. Within each tile of TILE_TOKENS tokens, reads are grouped by shard
+// (in their original order within a group), so a reader issues one batched NoC request per shard the tile touches
+// instead of one per read. Read slot p fetches local_indices[p] from its batch's shard and belongs at read position
+// read_offsets[p] of its tile, as for GatherPlan. Tile t's batches are batches[tile_batches[t], tile_batches[t + 1]).
+struct GatherRoute {
+    static constexpr uint32_t TILE_TOKENS = 1024;
+
+    std::vector<uint32_t> local_indices;
+    std::vector<uint32_t> read_offsets;
+    std::vector<ShardBatch> batches;
+    std::vector<size_t> tile_batches;
+};
+
+// Throws std::invalid_argument if accesses_per_token is 0 or doesn't divide the index vector, or an index falls
+// outside the sharded table.
+GatherRoute route_gather(
+    const std::vector<uint32_t> &index_vec, uint8_t accesses_per_token, const ShardLayout &layout);
+
+// Executes a routed gather against the shards on the host, as the device reader would: packed bf16 output with
+// accesses_per_token values per token.
+std::vector<uint32_t> gather_routed(
+    const std::vector<std::vector<uint32_t>> &shards, const GatherRoute &route, uint8_t accesses_per_token);
+
+// A GatherRoute as the gather example's device reader consumes it, one word per read in routed order:
+// read_offset << LOCAL_BITS | local index. Tile t's batches are implied by counts[t * counts_stride + shard], the
+// number of its reads going to each shard, since a tile's reads are grouped by shard in shard order. counts_stride
+// pads the shard count to a whole 32-byte DRAM read.
+struct PackedRoute {
+    static constexpr uint32_t LOCAL_BITS = 22;
+    static constexpr uint32_t LOCAL_MASK = (1U << LOCAL_BITS) - 1;
+
+    std::vector<uint32_t> reads;
+    std::vector<uint32_t> counts;
+    uint32_t counts_stride = 0;
+};
+
+// Throws std::invalid_argument if a shard holds 2^22 elements or more, or a tile more than 1024 reads (so a read
+// offset or local index would not fit its field).
+PackedRoute pack_route(const GatherRoute &route, const ShardLayout &layout);
+
+}  // namespace current::host
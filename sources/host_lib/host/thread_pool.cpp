@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+namespace current::host {
+
+ThreadPool::ThreadPool(size_t num_threads) {
+    if (num_threads == 0) {
+        num_threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    // The caller of parallel_for() acts as one of the threads.
+    for (size_t i = 1; i < num_threads; i++) {
+        workers.emplace_back([this] { worker_loop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    work_cv.notify_all();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+}
+
+ThreadPool &ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::parallel_for(size_t n, size_t grain, const std::function<void(size_t, size_t)> &fn) {
+    if (n == 0) {
+        return;
+    }
+    grain = std::max<size_t>(grain, 1);
+    // Over-decompose a little so uneven ranges still balance.
+    size_t chunk = std::max(grain, (n + size() * 4 - 1) / (size() * 4));
+    size_t chunks = (n + chunk - 1) / chunk;
+    if (chunks == 1 || workers.empty()) {
+        fn(0, n);
+        return;
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    // parallel_for() is not re-entrant; wait for any job started by another thread.
+    done_cv.wait(lock, [this] { return job == nullptr; });
+    job = &fn;
+    job_n = n;
+    job_chunk = chunk;
+    next_chunk = 0;
+    num_chunks = chunks;
+    chunks_done = 0;
+    error = nullptr;
+    generation++;
+    work_cv.notify_all();
+
+    while (next_chunk < num_chunks) {
+        run_chunk(lock, next_chunk++);
+    }
+    done_cv.wait(lock, [this] { return chunks_done == num_chunks; });
+    job = nullptr;
+    auto thrown = std::exchange(error, nullptr);
+    done_cv.notify_all();
+    lock.unlock();
+    if (thrown) {
+        std::rethrow_exception(thrown);
+    }
+}
+
+void ThreadPool::run_chunk(std::unique_lock<std::mutex> &lock, size_t c) {
+    const auto *fn = job;
+    size_t begin = c * job_chunk;
+    size_t end = std::min(job_n, begin + job_chunk);
+    lock.unlock();
+    std::exception_ptr thrown;
+    try {
+        (*fn)(begin, end);
+    } catch (...) {
+        thrown = std::current_exception();
+    }
+    lock.lock();
+    chunks_done++;
+    if (thrown) {
+        // Keep the first exception and retire the ranges nobody has started, so the job still completes.
+        if (!error) {
+            error = thrown;
+        }
+        chunks_done += num_chunks - next_chunk;
+        next_chunk = num_chunks;
+    }
+    if (chunks_done == num_chunks) {
+        done_cv.notify_all();
+    }
+}
+
+void ThreadPool::worker_loop() {
+    size_t seen_generation = 0;
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        work_cv.wait(lock, [&] { return stopping || (job != nullptr && generation != seen_generation); });
+        if (stopping) {
+            return;
+        }
+        seen_generation = generation;
+        while (job != nullptr && next_chunk < num_chunks) {
+            run_chunk(lock, next_chunk++);
+        }
+    }
+}
+
+}  // namespace current::host
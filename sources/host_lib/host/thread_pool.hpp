@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace current::host {
+
+// Fixed-size pool of worker threads used to split host-side work (tiles, chunks) across cores.
+class ThreadPool {
+   public:
+    // num_threads == 0 uses every hardware thread.
+    explicit ThreadPool(size_t num_threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    size_t size() const { return workers.size() + 1; }
+
+    // Calls fn(begin, end) over contiguous sub-ranges of [0, n), each at least `grain` long.
+    // The calling thread participates and the call blocks until every range has finished. If fn throws (on any
+    // thread), ranges not yet started are skipped and the first exception is rethrown here; the pool stays usable.
+    void parallel_for(size_t n, size_t grain, const std::function<void(size_t, size_t)> &fn);
+
+    // Process-wide pool sized to the machine.
+    static ThreadPool &global();
+
+   private:
+    void worker_loop();
+    // Runs one range of the current job; called and returns with `lock` held.
+    void run_chunk(std::unique_lock<std::mutex> &lock, size_t c);
+
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable work_cv;
+    std::condition_variable done_cv;
+
+    // Current job, guarded by `mutex`.
+    const std::function<void(size_t, size_t)> *job = nullptr;
+    size_t job_n = 0;
+    size_t job_chunk = 0;
+    size_t next_chunk = 0;
+    size_t num_chunks = 0;
+    size_t chunks_done = 0;
+    std::exception_ptr error;  // First exception thrown by the current job.
+    size_t generation = 0;
+    bool stopping = false;
+};
+
+}  // namespace current::host
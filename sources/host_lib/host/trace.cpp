@@ -0,0 +1,156 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "trace.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <set>
+#include <stdexcept>
+
+namespace current::host {
+
+namespace {
+
+constexpr uint32_t HEADER_WORDS = sizeof(trace::TraceHeader) / sizeof(uint32_t);
+constexpr uint32_t RECORD_WORDS = sizeof(trace::TraceRecord) / sizeof(uint32_t);
+
+const char *risc_name(trace::TraceRisc risc) {
+    static const char *names[] = {"BRISC", "NCRISC", "TRISC0", "TRISC1", "TRISC2"};
+    return names[risc];
+}
+
+const char *kind_name(trace::TraceKind kind) {
+    static const char *names[] = {"zone_begin", "zone_end", "mark", "noc_read", "noc_write"};
+    return names[kind];
+}
+
+std::string event_name(const TraceEvent &event, const TraceNames &names) {
+    if (event.kind == trace::NOC_READ || event.kind == trace::NOC_WRITE) {
+        return kind_name(event.kind);
+    }
+    auto it = names.find(event.id);
+    return it != names.end() ? it->second : std::to_string(event.id);
+}
+
+// Names only ever come from the caller, but keep the JSON valid whatever they contain.
+std::string json_escape(const std::string &s) {
+    std::string out;
+    for (char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+uint32_t core_pid(const TraceEvent &event) { return event.core_y << 16 | event.core_x; }
+
+}  // namespace
+
+std::vector<uint32_t> empty_trace_rings(uint32_t capacity) {
+    std::vector<uint32_t> words(trace::NUM_RISCS * trace::trace_ring_bytes(capacity) / sizeof(uint32_t), 0);
+    for (uint32_t risc = 0; risc < trace::NUM_RISCS; risc++) {
+        uint32_t *header = words.data() + risc * (HEADER_WORDS + capacity * RECORD_WORDS);
+        header[0] = trace::TRACE_MAGIC;
+        header[1] = capacity;
+    }
+    return words;
+}
+
+std::map<std::string, std::string> trace_defines(uint32_t address, uint32_t capacity) {
+    return {{"CURRENT_TRACE_ADDR", std::to_string(address)}, {"CURRENT_TRACE_CAPACITY", std::to_string(capacity)}};
+}
+
+void decode_trace(
+    const std::vector<uint32_t> &words, uint32_t capacity, uint32_t core_x, uint32_t core_y, DecodedTrace &trace) {
+    uint32_t ring_words = HEADER_WORDS + capacity * RECORD_WORDS;
+    if (capacity == 0 || words.size() != size_t{ring_words} * trace::NUM_RISCS) {
+        throw std::invalid_argument(
+            "decode_trace: expected " + std::to_string(size_t{ring_words} * trace::NUM_RISCS) + " words, got " +
+            std::to_string(words.size()));
+    }
+    for (uint32_t risc = 0; risc < trace::NUM_RISCS; risc++) {
+        const uint32_t *header = words.data() + risc * ring_words;
+        const uint32_t *records = header + HEADER_WORDS;
+        if (header[0] != trace::TRACE_MAGIC || header[1] != capacity) {
+            throw std::invalid_argument("decode_trace: ring " + std::to_string(risc) + " has a bad header");
+        }
+        uint32_t written = header[2];
+        uint32_t kept = std::min(written, capacity);
+        trace.dropped += written - kept;
+        for (uint32_t n = written - kept; n < written; n++) {
+            const uint32_t *record = records + (n % capacity) * RECORD_WORDS;
+            uint32_t kind = record[2] >> 24;
+            if (kind > trace::NOC_WRITE) {
+                throw std::invalid_argument("decode_trace: unknown record kind " + std::to_string(kind));
+            }
+            TraceEvent event;
+            event.core_x = core_x;
+            event.core_y = core_y;
+            event.risc = static_cast<trace::TraceRisc>(risc);
+            event.kind = static_cast<trace::TraceKind>(kind);
+            event.id = record[2] & 0xFFFFFF;
+            event.arg = record[3];
+            event.cycles = uint64_t{record[1]} << 32 | record[0];
+            trace.events.push_back(event);
+        }
+    }
+}
+
+void write_trace_csv(std::ostream &out, const DecodedTrace &trace, const TraceNames &names) {
+    out << "core_x,core_y,risc,kind,id,name,arg,cycles\n";
+    for (const auto &event : trace.events) {
+        out << event.core_x << "," << event.core_y << "," << risc_name(event.risc) << "," << kind_name(event.kind)
+            << "," << event.id << "," << event_name(event, names) << "," << event.arg << "," << event.cycles << "\n";
+    }
+}
+
+void write_chrome_trace(std::ostream &out, const DecodedTrace &trace, const TraceNames &names, double cycles_per_us) {
+    uint64_t origin = UINT64_MAX;
+    std::set<std::pair<uint32_t, uint32_t>> threads;  // (pid, tid)
+    for (const auto &event : trace.events) {
+        origin = std::min(origin, event.cycles);
+        threads.insert({core_pid(event), event.risc});
+    }
+
+    out << "{\"traceEvents\":[";
+    bool first = true;
+    auto separator = [&] {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+    std::set<uint32_t> processes;
+    for (auto [pid, tid] : threads) {
+        if (processes.insert(pid).second) {
+            separator();
+            out << "{\"ph\":\"M\",\"name\":\"process_name\",\"pid\":" << pid << ",\"args\":{\"name\":\"core ("
+                << (pid & 0xFFFF) << ", " << (pid >> 16) << ")\"}}";
+        }
+        separator();
+        out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":" << pid << ",\"tid\":" << tid
+            << ",\"args\":{\"name\":\"" << risc_name(static_cast<trace::TraceRisc>(tid)) << "\"}}";
+    }
+    out << std::fixed << std::setprecision(3);
+    for (const auto &event : trace.events) {
+        const char *phase = event.kind == trace::ZONE_BEGIN ? "B" : event.kind == trace::ZONE_END ? "E" : "i";
+        separator();
+        out << "{\"ph\":\"" << phase << "\",\"name\":\"" << json_escape(event_name(event, names))
+            << "\",\"pid\":" << core_pid(event) << ",\"tid\":" << uint32_t{event.risc}
+            << ",\"ts\":" << static_cast<double>(event.cycles - origin) / cycles_per_us;
+        if (event.kind == trace::MARK || event.kind == trace::NOC_READ || event.kind == trace::NOC_WRITE) {
+            const char *key = event.kind == trace::MARK ? "value" : "bytes";
+            out << ",\"s\":\"t\",\"args\":{\"" << key << "\":" << event.arg << "}";
+        }
+        out << "}";
+    }
+    out << "\n]}\n";
+}
+
+}  // namespace current::host
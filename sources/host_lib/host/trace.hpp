@@ -0,0 +1,56 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "trace_format.hpp"
+
+namespace current::host {
+
+// Initial contents of one core's trace rings (all RISCs), to be written to L1 at CURRENT_TRACE_ADDR before a launch.
+std::vector<uint32_t> empty_trace_rings(uint32_t capacity);
+
+// Kernel defines that turn the device/trace.hpp macros on for rings at `address`.
+std::map<std::string, std::string> trace_defines(uint32_t address, uint32_t capacity);
+
+struct TraceEvent {
+    uint32_t core_x = 0;
+    uint32_t core_y = 0;
+    trace::TraceRisc risc = trace::BRISC;
+    trace::TraceKind kind = trace::MARK;
+    uint32_t id = 0;
+    uint32_t arg = 0;
+    uint64_t cycles = 0;  // Device wall clock.
+};
+
+struct DecodedTrace {
+    std::vector<TraceEvent> events;  // Per ring in the order written; rings in core, then RISC order.
+    uint64_t dropped = 0;            // Records overwritten because a ring wrapped.
+};
+
+// Appends the events of one core's rings, as read back from L1, to `trace`. A ring that wrapped yields its newest
+// `capacity` records. Throws std::invalid_argument if the words are not a core's rings of that capacity (wrong size,
+// bad magic) or a record has an unknown kind.
+void decode_trace(
+    const std::vector<uint32_t> &words, uint32_t capacity, uint32_t core_x, uint32_t core_y, DecodedTrace &trace);
+
+// Names for zone and marker ids in the exports; ids without one print as their number.
+using TraceNames = std::map<uint32_t, std::string>;
+
+// One row per event: core_x,core_y,risc,kind,id,name,arg,cycles.
+void write_trace_csv(std::ostream &out, const DecodedTrace &trace, const TraceNames &names = {});
+
+// Chrome trace event JSON (chrome://tracing, Perfetto): a process per core, a thread per RISC, zones as B/E pairs,
+// markers and NoC transactions as instants carrying their argument. Times are microseconds from the earliest event
+// at `cycles_per_us` (the AI clock in MHz).
+void write_chrome_trace(
+    std::ostream &out, const DecodedTrace &trace, const TraceNames &names = {}, double cycles_per_us = 1000.0);
+
+}  // namespace current::host
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+// L1 layout of the per-core trace rings, shared by the device macros (device/trace.hpp) and the host decoder
+// (host/trace.hpp). Kept to plain C types so it compiles for the RISCs.
+
+#include <stdint.h>
+
+namespace current::trace {
+
+// RISC that wrote a ring. Each RISC of a core gets its own ring, so records never race.
+enum TraceRisc : uint8_t {
+    BRISC = 0,
+    NCRISC = 1,
+    TRISC0 = 2,
+    TRISC1 = 3,
+    TRISC2 = 4,
+    NUM_RISCS = 5,
+};
+
+enum TraceKind : uint8_t {
+    ZONE_BEGIN = 0,  // id: zone
+    ZONE_END = 1,    // id: zone
+    MARK = 2,        // id: marker, arg: user value
+    NOC_READ = 3,    // arg: bytes
+    NOC_WRITE = 4,   // arg: bytes
+};
+
+constexpr uint32_t TRACE_MAGIC = 0x54524331;  // "TRC1"
+
+// One ring: a header followed by `capacity` records. `written` counts every record ever appended; record n lives in
+// slot n % capacity, so once written > capacity the oldest written - capacity records have been overwritten.
+struct TraceHeader {
+    uint32_t magic;
+    uint32_t capacity;
+    uint32_t written;
+    uint32_t reserved;
+};
+
+// 16 bytes: the wall-clock cycle counter, what happened, and one argument.
+struct TraceRecord {
+    uint32_t time_lo;
+    uint32_t time_hi;
+    uint32_t tag;  // kind << 24 | id
+    uint32_t arg;
+};
+
+constexpr uint32_t trace_tag(uint8_t kind, uint32_t id) { return (uint32_t(kind) << 24) | (id & 0xFFFFFF); }
+
+// Bytes one ring of `capacity` records takes; a core's rings are laid out back to back, BRISC first.
+constexpr uint32_t trace_ring_bytes(uint32_t capacity) {
+    return sizeof(TraceHeader) + capacity * sizeof(TraceRecord);
+}
+
+}  // namespace current::trace
@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "work_split.hpp"
+
+#include <algorithm>
+#include <sstream>
+#include <stdexcept>
+
+namespace current::host {
+
+uint32_t WorkSplit::max_tiles_per_core() const {
+    uint32_t max = 0;
+    for (const auto &core : cores) {
+        max = std::max(max, core.num_tiles);
+    }
+    return max;
+}
+
+std::string WorkSplit::describe() const {
+    std::ostringstream out;
+    for (const auto &core : cores) {
+        out << "(" << core.x << ", " << core.y << "): tiles [" << core.first_tile << ", "
+            << core.first_tile + core.num_tiles << ")\n";
+    }
+    return out.str();
+}
+
+WorkSplit split_work(uint32_t num_tiles, uint32_t max_cores, CoreGrid grid, uint32_t granularity) {
+    if (granularity == 0) {
+        throw std::invalid_argument("split_work: granularity must be positive");
+    }
+    if (grid.size() == 0) {
+        throw std::invalid_argument("split_work: empty core grid");
+    }
+    WorkSplit split;
+    split.num_tiles = num_tiles;
+    uint32_t units = (num_tiles + granularity - 1) / granularity;
+    uint32_t cores = std::min({max_cores == 0 ? grid.size() : max_cores, grid.size(), units});
+    if (cores == 0) {
+        return split;
+    }
+
+    uint32_t per_core = units / cores;
+    uint32_t extra = units % cores;
+    uint32_t first = 0;
+    for (uint32_t i = 0; i < cores; i++) {
+        uint32_t tiles = (per_core + (i < extra ? 1 : 0)) * granularity;
+        tiles = std::min(tiles, num_tiles - first);
+        split.cores.push_back({i / grid.y, i % grid.y, first, tiles});
+        first += tiles;
+    }
+    return split;
+}
+
+}  // namespace current::host
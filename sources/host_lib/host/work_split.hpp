@@ -0,0 +1,46 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace current::host {
+
+// Tensix worker grid. Defaults to the 8x8 compute grid of a Wormhole n150.
+struct CoreGrid {
+    uint32_t x = 8;
+    uint32_t y = 8;
+
+    uint32_t size() const { return x * y; }
+};
+
+struct CoreWork {
+    uint32_t x;
+    uint32_t y;
+    uint32_t first_tile;
+    uint32_t num_tiles;
+};
+
+// Contiguous, non-overlapping tile ranges covering [0, num_tiles), one per core, in tile order.
+struct WorkSplit {
+    uint32_t num_tiles = 0;
+    std::vector<CoreWork> cores;
+
+    uint32_t max_tiles_per_core() const;
+    // One line per core: "(x, y): tiles [first, end)".
+    std::string describe() const;
+};
+
+// Splits `num_tiles` over at most `max_cores` cores of `grid` (0 = the whole grid). Any core count works, including
+// odd and prime ones: work is dealt out in units of `granularity` tiles, every core gets floor(units / cores) units
+// and the first units % cores cores one more, and the final unit absorbs a tile remainder smaller than `granularity`.
+// Never assigns a core zero tiles, so fewer cores than requested are used when there is little work. Cores are
+// numbered column-major over the grid, as in tt_metal's split_work_to_cores.
+// Throws std::invalid_argument if `granularity` is 0.
+WorkSplit split_work(uint32_t num_tiles, uint32_t max_cores, CoreGrid grid = {}, uint32_t granularity = 1);
+
+}  // namespace current::host
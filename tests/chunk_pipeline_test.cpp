@@ -0,0 +1,42 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <array>
+#include <stdexcept>
+#include <vector>
+
+#include "host/chunk_pipeline.hpp"
+
+using namespace current::host;
+
+TEST(ChunkPipelineTests, EveryChunkFlowsThroughItsSlot) {
+    constexpr size_t num_chunks = 9;
+    std::array<int, 2> input_slots{};
+    std::array<int, 2> output_slots{};
+    std::vector<int> host_out(num_chunks, -1);
+
+    run_double_buffered(
+        num_chunks,
+        {[&](size_t chunk, size_t slot) { input_slots[slot] = static_cast<int>(chunk) * 10; },
+         [&](size_t, size_t slot) { output_slots[slot] = input_slots[slot] + 1; },
+         [&](size_t chunk, size_t slot) { host_out[chunk] = output_slots[slot]; }});
+
+    for (size_t chunk = 0; chunk < num_chunks; chunk++) {
+        EXPECT_EQ(host_out[chunk], static_cast<int>(chunk) * 10 + 1);
+    }
+}
+
+TEST(ChunkPipelineTests, PropagatesErrors) {
+    auto noop = [](size_t, size_t) {};
+    auto fail_on_3 = [](size_t chunk, size_t) {
+        if (chunk == 3) {
+            throw std::runtime_error("transfer failed");
+        }
+    };
+    EXPECT_THROW(run_double_buffered(5, {fail_on_3, noop, noop}), std::runtime_error);
+    EXPECT_THROW(run_double_buffered(5, {noop, noop, fail_on_3}), std::runtime_error);
+    EXPECT_NO_THROW(run_double_buffered(0, {fail_on_3, fail_on_3, fail_on_3}));
+}
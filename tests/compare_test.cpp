@@ -0,0 +1,59 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "host/bf16.hpp"
+#include "host/compare.hpp"
+
+using namespace current::host;
+
+TEST(CompareTests, IdenticalBuffersPass) {
+    std::vector<float> values(100000);
+    for (size_t i = 0; i < values.size(); i++) {
+        values[i] = static_cast<float>(i % 977) * 0.37F - 100.0F;
+    }
+    auto packed = pack_bf16_vec(values);
+    auto result = compare_bf16(packed, packed, values.size());
+    EXPECT_TRUE(result.passed());
+    EXPECT_EQ(result.count, values.size());
+    EXPECT_EQ(result.ulp_histogram[0], values.size());
+    EXPECT_EQ(result.max_abs_error, 0.0F);
+}
+
+TEST(CompareTests, ReportsMismatchesInIndexOrder) {
+    std::vector<float> expected(50000, 1.0F);
+    std::vector<float> actual_values = expected;
+    actual_values[49000] = 3.0F;
+    actual_values[7] = 1.5F;
+    actual_values[20000] = bf16_to_float(static_cast<uint16_t>(float_to_bf16(1.0F) + 1));  // One ulp off: within rtol.
+    auto actual = pack_bf16_vec(actual_values);
+
+    CompareOptions options;
+    options.max_reported = 1;
+    auto result = compare_bf16(expected, actual, expected.size(), options);
+    EXPECT_FALSE(result.passed());
+    EXPECT_EQ(result.mismatches, 2);
+    ASSERT_EQ(result.first_mismatches.size(), 1);
+    EXPECT_EQ(result.first_mismatches[0].index, 7);
+    EXPECT_EQ(result.max_abs_error, 2.0F);
+    EXPECT_EQ(result.max_abs_error_index, 49000);
+    EXPECT_EQ(result.ulp_histogram[1], 1);
+    EXPECT_EQ(result.ulp_histogram[0], expected.size() - 3);
+}
+
+TEST(CompareTests, PackUnpackVectors) {
+    std::vector<float> values = {1.0F, 2.0F, 3.0F};
+    auto packed = pack_bf16_vec(values);
+    ASSERT_EQ(packed.size(), 2);
+    auto unpacked = unpack_bf16_vec(packed);
+    ASSERT_EQ(unpacked.size(), 4);
+    EXPECT_EQ(unpacked[0], 1.0F);
+    EXPECT_EQ(unpacked[1], 2.0F);
+    EXPECT_EQ(unpacked[2], 3.0F);
+    EXPECT_EQ(unpacked[3], 0.0F);
+}
@@ -0,0 +1,104 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include "host/bf16.hpp"
+#include "host/convolution.hpp"
+#include "host/cpu_map.hpp"
+
+using namespace current::host;
+
+namespace {
+
+std::vector<uint32_t> random_image(size_t count, int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(0.0F, 1.0F);
+    std::vector<float> values(count);
+    for (auto &v : values) {
+        v = dist(rng);
+    }
+    return pack_bf16_vec(values);
+}
+
+float at(const std::vector<uint32_t> &packed, size_t i) { return bf16_to_float(packed_bf16_at(packed.data(), i)); }
+
+}  // namespace
+
+TEST(ConvolutionTests, MatchesDirectConvolution) {
+    // Odd width so rows straddle packed words, and a height that leaves a short last band.
+    uint32_t width = 71;
+    uint32_t height = 53;
+    auto image = random_image(size_t{width} * height, 70);
+    SeparableFilter filter;
+    filter.horizontal = {0.1F, 0.2F, 0.4F, 0.2F, 0.1F};
+    filter.vertical = {0.25F, 0.5F, 0.25F};
+
+    for (auto boundary : {Boundary::Clamp, Boundary::Zero, Boundary::Wrap}) {
+        // The same taps as a stencil: its addressing is the reference for every boundary policy.
+        std::vector<StencilStream::Offset> offsets;
+        for (int32_t dy = -1; dy <= 1; dy++) {
+            for (int32_t dx = -2; dx <= 2; dx++) {
+                offsets.push_back({dx, dy});
+            }
+        }
+        StencilStream stencil(image, width, height, offsets, boundary);
+        auto out = convolve_separable(image, width, height, filter, boundary);
+        for (uint32_t t = 0; t < width * height; t++) {
+            float expected = 0.0F;
+            for (uint32_t j = 0; j < stencil.taps(); j++) {
+                int64_t index = stencil.neighbor(t, j);
+                float weight = filter.horizontal[offsets[j].dx + 2] * filter.vertical[offsets[j].dy + 1];
+                expected += index < 0 ? 0.0F : weight * at(image, index);
+            }
+            // The row pass is rounded to bf16 before the column pass.
+            ASSERT_NEAR(expected, at(out, t), 0.02F) << "t = " << t << ", boundary = " << static_cast<int>(boundary);
+        }
+    }
+}
+
+TEST(ConvolutionTests, HorizontalBoxBlur) {
+    // The reference of the BoxFilter e2e test: zero padding, divide by the full kernel size.
+    uint32_t width = 512;
+    uint32_t height = 9;
+    auto image = random_image(size_t{width} * height, 71);
+    for (uint32_t radius : {0U, 1U, 4U}) {
+        auto out = convolve_separable(image, width, height, SeparableFilter::box(radius));
+        auto kernel_size = static_cast<int>(2 * radius + 1);
+        for (int y = 0; y < static_cast<int>(height); y++) {
+            for (int x = 0; x < static_cast<int>(width); x++) {
+                float sum = 0.0F;
+                for (int px = x - kernel_size / 2; px <= x + kernel_size / 2; px++) {
+                    if (px >= 0 && px < static_cast<int>(width)) {
+                        sum += at(image, y * width + px);
+                    }
+                }
+                float expected = sum / static_cast<float>(kernel_size);
+                ASSERT_NEAR(expected, at(out, y * width + x), expected * 0.01F + 1e-3F) << "x = " << x << ", y = " << y;
+            }
+        }
+    }
+}
+
+TEST(ConvolutionTests, RadiusLargerThanImage) {
+    // Every tap wraps more than once around a 3 x 2 image: each output is the mean of the whole image.
+    std::vector<float> values = {1.0F, 2.0F, 3.0F, 4.0F, 5.0F, 6.0F};
+    SeparableFilter filter;
+    filter.horizontal.assign(9, 1.0F / 9.0F);
+    filter.vertical.assign(5, 1.0F / 5.0F);
+    auto out = convolve_separable(pack_bf16_vec(values), 3, 2, filter, Boundary::Wrap);
+    for (size_t i = 0; i < values.size(); i++) {
+        // Rows: (r0 * 3 + r1 * 2) / 5 of the row means 2 and 5, or the other way around.
+        float expected = i < 3 ? (2.0F * 3 + 5.0F * 2) / 5 : (5.0F * 3 + 2.0F * 2) / 5;
+        EXPECT_NEAR(at(out, i), expected, 0.05F) << "i = " << i;
+    }
+
+    EXPECT_THROW(convolve_separable(pack_bf16_vec(values), 3, 3, filter), std::invalid_argument);
+    filter.vertical = {0.5F, 0.5F};
+    EXPECT_THROW(convolve_separable(pack_bf16_vec(values), 3, 2, filter), std::invalid_argument);
+}
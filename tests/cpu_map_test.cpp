@@ -0,0 +1,865 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <random>
+#include <vector>
+
+#include "host/bf16.hpp"
+#include "host/cpu_map.hpp"
+
+using namespace current::host;
+
+namespace {
+
+std::vector<uint32_t> random_bf16(size_t count, float max_float, int seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> dist(-max_float, max_float);
+    std::vector<uint32_t> packed((count + 1) / 2, 0);
+    for (size_t i = 0; i < count; i++) {
+        packed[i / 2] |= static_cast<uint32_t>(float_to_bf16(dist(rng))) << (16 * (i & 1));
+    }
+    return packed;
+}
+
+float at(const std::vector<uint32_t> &packed, size_t i) { return bf16_to_float(packed_bf16_at(packed.data(), i)); }
+
+float round_bf16(float value) { return bf16_to_float(float_to_bf16(value)); }
+
+}  // namespace
+
+TEST(Bf16Tests, RoundTrip) {
+    std::vector<float> values = {0.0F, -0.0F, 1.0F, -2.5F, 3.14159F, 1e-30F, 65504.0F, 1.00390625F};
+    std::vector<uint32_t> packed((values.size() + 1) / 2);
+    pack_bf16(values.data(), values.size(), packed.data(), 0);
+    std::vector<float> out(values.size());
+    unpack_bf16(packed.data(), 0, values.size(), out.data());
+    for (size_t i = 0; i < values.size(); i++) {
+        EXPECT_EQ(out[i], round_bf16(values[i]));
+    }
+}
+
+TEST(Bf16Tests, VectorMatchesScalar) {
+    // Odd length so both the SIMD body and the scalar tail run.
+    constexpr size_t count = 1024 + 37;
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> dist(-1000.0F, 1000.0F);
+    std::vector<float> values(count);
+    for (auto &v : values) {
+        v = dist(rng);
+    }
+    for (auto rounding : {Rounding::NearestEven, Rounding::Truncate}) {
+        std::vector<uint32_t> packed((count + 1) / 2, 0xFFFFFFFFU);
+        pack_bf16(values.data(), count, packed.data(), 0, rounding);
+        std::vector<float> rounded = values;
+        round_to_bf16(rounded.data(), count, rounding);
+        for (size_t i = 0; i < count; i++) {
+            EXPECT_EQ(packed_bf16_at(packed.data(), i), float_to_bf16(values[i], rounding));
+            EXPECT_EQ(rounded[i], bf16_to_float(float_to_bf16(values[i], rounding)));
+        }
+    }
+}
+
+TEST(CpuMapTests, B16EltwiseSAXPY) {
+    uint32_t count = 1024 * 512 + 100;
+    auto in0 = random_bf16(count, 10.0F, 1);
+    auto in1 = random_bf16(count, 10.0F, 2);
+    std::vector<uint32_t> output((count + 1) / 2, 0);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_input_port("in1");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel(R"(
+        out0 = in0 * 2.0 + in1;
+    )");
+
+    Stream source0(in0, count);
+    Stream source1(in1, count);
+    Stream sink(output, count);
+
+    CpuMap map({&kernel_a}, {&source0, &source1, &sink});
+    map.add_connection(&source0, &kernel_a, "in0");
+    map.add_connection(&source1, &kernel_a, "in1");
+    map.add_connection(&kernel_a, "out0", &sink);
+    map.execute();
+
+    auto out = map.read_stream(&sink);
+    for (size_t i = 0; i < count; i++) {
+        float expected = round_bf16(round_bf16(at(in0, i) * 2.0F) + at(in1, i));
+        ASSERT_EQ(expected, at(out, i)) << "i = " << i;
+    }
+}
+
+TEST(CpuMapTests, Pipeline) {
+    uint32_t count = 1024 * 64;
+    auto in0 = random_bf16(count, 10.0F, 3);
+    std::vector<uint32_t> output(count / 2, 0);
+
+    Kernel kernel_a;
+    Kernel kernel_b;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_b.add_input_port("in0");
+    kernel_b.add_output_port("out0");
+    kernel_b.set_compute_kernel("out0 = -in0 - 1.0;");
+
+    Stream source0(in0, count);
+    Stream sink(output, count);
+
+    CpuMap map({&kernel_b, &kernel_a}, {&source0, &sink}, 3);
+    map.add_connection(&source0, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &kernel_b, "in0");
+    map.add_connection(&kernel_b, "out0", &sink);
+    map.execute();
+
+    auto out = map.read_stream(&sink);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(round_bf16(-at(in0, i) - 1.0F), at(out, i)) << "i = " << i;
+    }
+}
+
+TEST(CpuMapTests, GatherMultipleAccesses) {
+    uint32_t table_n_elements = 1024 * 16;
+    uint32_t num_tokens = 1024 * 8;
+    uint8_t accesses_per_token = 2;
+    auto table = random_bf16(table_n_elements, 10.0F, 4);
+
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<uint32_t> dist(0, table_n_elements - 1);
+    std::vector<uint32_t> index_vec(num_tokens * accesses_per_token);
+    for (auto &index : index_vec) {
+        index = dist(rng);
+    }
+    std::vector<uint32_t> output(num_tokens / 2, 0);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = (in0 + in1) * 0.5;");
+
+    GatherStream gather_stream(table, table_n_elements, index_vec, accesses_per_token);
+    Stream sink(output, num_tokens);
+
+    CpuMap map({&kernel_a}, {&gather_stream, &sink});
+    map.add_connection(&gather_stream, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &sink);
+    map.execute();
+
+    auto out = map.read_stream(&sink);
+    for (size_t i = 0; i < num_tokens; i++) {
+        float a = at(table, index_vec[i * 2]);
+        float b = at(table, index_vec[i * 2 + 1]);
+        ASSERT_EQ(round_bf16(round_bf16(a + b) * 0.5F), at(out, i)) << "token " << i;
+    }
+
+    EXPECT_THROW(GatherStream(table, table_n_elements, index_vec, 0), std::invalid_argument);
+    EXPECT_THROW(GatherStream(table, table_n_elements, std::vector<uint32_t>(3), 2), std::invalid_argument);
+}
+
+TEST(CpuMapTests, RejectsUnconnectedPort) {
+    std::vector<uint32_t> data(512, 0);
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_input_port("in1");
+    kernel_a.add_output_port("out0");
+    Stream source0(data, 1024);
+    Stream sink(data, 1024);
+
+    CpuMap map({&kernel_a}, {&source0, &sink});
+    map.add_connection(&source0, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &sink);
+    EXPECT_THROW(map.execute(), std::runtime_error);
+}
+
+TEST(CpuMapTests, FusedChainMatchesUnfused) {
+    uint32_t count = 1024 * 16 + 10;
+    auto in0 = random_bf16(count, 10.0F, 6);
+    auto in1 = random_bf16(count, 10.0F, 7);
+
+    Kernel kernel_a;
+    Kernel kernel_b;
+    Kernel kernel_c;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 * 3.0;");
+    kernel_b.add_input_port("in0");
+    kernel_b.add_input_port("in1");
+    kernel_b.add_output_port("out0");
+    kernel_b.set_compute_kernel("out0 = in1 - in0;");
+    kernel_c.add_input_port("in0");
+    kernel_c.add_output_port("out0");
+    kernel_c.set_compute_kernel("out0 = in0 + 1.0;");
+
+    std::vector<std::vector<uint32_t>> outs;
+    std::vector<size_t> stages;
+    for (bool fusion : {true, false}) {
+        Stream source0(in0, count);
+        Stream source1(in1, count);
+        Stream sink(std::vector<uint32_t>((count + 1) / 2, 0), count);
+        CpuMap map({&kernel_a, &kernel_b, &kernel_c}, {&source0, &source1, &sink});
+        map.add_connection(&source0, &kernel_a, "in0");
+        map.add_connection(&kernel_a, "out0", &kernel_b, "in0");
+        map.add_connection(&source1, &kernel_b, "in1");
+        map.add_connection(&kernel_b, "out0", &kernel_c, "in0");
+        map.add_connection(&kernel_c, "out0", &sink);
+        map.set_fusion(fusion);
+        stages.push_back(map.plan().size());
+        map.execute();
+        outs.push_back(map.read_stream(&sink));
+    }
+    EXPECT_EQ(stages[0], 1);
+    EXPECT_EQ(stages[1], 3);
+    EXPECT_EQ(outs[0], outs[1]);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(round_bf16(round_bf16(at(in1, i) - round_bf16(at(in0, i) * 3.0F)) + 1.0F), at(outs[0], i));
+    }
+}
+
+TEST(CpuMapTests, FanOutIsNotFused) {
+    std::vector<uint32_t> data(512, 0);
+    Kernel kernel_a;
+    Kernel kernel_b;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 * 3.0;");
+    kernel_b.add_input_port("in0");
+    kernel_b.add_output_port("out0");
+    kernel_b.set_compute_kernel("out0 = in0 + 1.0;");
+    Stream source0(data, 1024);
+    Stream sink0(data, 1024);
+    Stream sink1(data, 1024);
+
+    // kernel_a's output also goes to a sink, so it has to be materialized.
+    CpuMap map({&kernel_a, &kernel_b}, {&source0, &sink0, &sink1});
+    map.add_connection(&source0, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &kernel_b, "in0");
+    map.add_connection(&kernel_a, "out0", &sink0);
+    map.add_connection(&kernel_b, "out0", &sink1);
+    auto plan = map.plan();
+    ASSERT_EQ(plan.size(), 2);
+    EXPECT_EQ(plan[0].kernels, (std::vector<Kernel *>{&kernel_a}));
+    EXPECT_EQ(plan[1].ops.sfpu, 1);
+}
+
+TEST(CpuMapTests, ExecuteManyTimesWithRebind) {
+    uint32_t count = 1024 * 8 + 3;
+    uint32_t table_n_elements = 1024;
+    auto table = random_bf16(table_n_elements, 10.0F, 8);
+    std::vector<uint32_t> index_vec(count);
+    std::vector<uint32_t> output((count + 1) / 2, 0);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_input_port("in1");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 + in1;");
+
+    GatherStream gather_stream(table, table_n_elements, index_vec);
+    Stream source1(random_bf16(count, 10.0F, 9), count);
+    Stream sink(output, count);
+
+    KernelCache cache(std::filesystem::temp_directory_path() / "cpu_map_test_rebind");
+    std::filesystem::remove_all(cache.directory());
+    CpuMap map({&kernel_a}, {&gather_stream, &source1, &sink});
+    map.add_connection(&gather_stream, &kernel_a, "in0");
+    map.add_connection(&source1, &kernel_a, "in1");
+    map.add_connection(&kernel_a, "out0", &sink);
+    map.set_kernel_cache(&cache);
+
+    for (int run = 0; run < 3; run++) {
+        auto in1 = random_bf16(count, 10.0F, 10 + run);
+        auto new_table = random_bf16(table_n_elements, 10.0F, 20 + run);
+        for (size_t i = 0; i < count; i++) {
+            index_vec[i] = (i * 7 + run) % table_n_elements;
+        }
+        map.rebind(&source1, in1);
+        map.rebind(&gather_stream, new_table, index_vec);
+        map.rebind(&sink, std::vector<uint32_t>(output.size(), 0));
+        map.execute();
+
+        auto out = map.read_stream(&sink);
+        for (size_t i = 0; i < count; i++) {
+            ASSERT_EQ(round_bf16(at(new_table, index_vec[i]) + at(in1, i)), at(out, i)) << "run " << run << ", i " << i;
+        }
+    }
+    // Compiled once, on the first execute().
+    EXPECT_EQ(cache.hits() + cache.misses(), 1);
+    std::filesystem::remove_all(cache.directory());
+
+    EXPECT_THROW(map.rebind(&source1, std::vector<uint32_t>(count / 4)), std::invalid_argument);
+    EXPECT_THROW(map.rebind(&gather_stream, table, std::vector<uint32_t>(count + 1)), std::invalid_argument);
+}
+
+TEST(CpuMapTests, RebindGatherTableBounds) {
+    uint32_t count = 1024;
+    uint32_t table_n_elements = 1024;
+    auto table = random_bf16(table_n_elements, 10.0F, 30);
+    std::vector<uint32_t> index_vec(count);
+    for (size_t i = 0; i < count; i++) {
+        index_vec[i] = table_n_elements - 1 - i;
+    }
+    std::vector<uint32_t> output(count / 2, 0);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0;");
+
+    GatherStream gather_stream(table, table_n_elements, index_vec);
+    Stream sink(output, count);
+    CpuMap map({&kernel_a}, {&gather_stream, &sink});
+    map.add_connection(&gather_stream, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &sink);
+
+    // One word short of table_n_elements is rejected; exactly table_n_elements is accepted.
+    auto exact = random_bf16(table_n_elements, 10.0F, 31);
+    EXPECT_THROW(
+        map.rebind(&gather_stream, std::vector<uint32_t>(exact.begin(), exact.end() - 1), index_vec),
+        std::invalid_argument);
+    map.rebind(&gather_stream, exact, index_vec);
+    map.execute();
+    auto out = map.read_stream(&sink);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(at(exact, index_vec[i]), at(out, i)) << "i = " << i;
+    }
+
+    // A longer table is accepted and only its first table_n_elements values are used.
+    auto longer = random_bf16(table_n_elements * 2, 10.0F, 32);
+    map.rebind(&gather_stream, longer, index_vec);
+    map.execute();
+    out = map.read_stream(&sink);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(at(longer, index_vec[i]), at(out, i)) << "i = " << i;
+    }
+}
+
+TEST(CpuMapTests, PrimeCoreCount) {
+    uint32_t count = 1024 * 100 + 5;
+    auto in0 = random_bf16(count, 10.0F, 30);
+    std::vector<uint32_t> output((count + 1) / 2, 0);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 * in0;");
+
+    Stream source0(in0, count);
+    Stream sink(output, count);
+    CpuMap map({&kernel_a}, {&source0, &sink});
+    map.add_connection(&source0, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &sink);
+    map.set_parallelization(13);
+    map.execute();
+
+    ASSERT_EQ(map.core_assignment().size(), 1);
+    const auto &split = map.core_assignment()[0];
+    EXPECT_EQ(split.num_tiles, 101);
+    EXPECT_EQ(split.cores.size(), 13);
+    EXPECT_EQ(split.max_tiles_per_core(), 8);
+    auto out = map.read_stream(&sink);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(round_bf16(at(in0, i) * at(in0, i)), at(out, i)) << "i = " << i;
+    }
+}
+
+TEST(CpuMapTests, ChunkedMatchesWholeStream) {
+    // Not a multiple of the chunk size, so the last chunk is partial.
+    uint32_t count = 1024 * 37 + 11;
+    uint32_t table_n_elements = 4096;
+    auto in0 = random_bf16(count, 10.0F, 40);
+    auto table = random_bf16(table_n_elements, 10.0F, 41);
+    std::mt19937 rng(42);
+    std::vector<uint32_t> index_vec(count * 2);
+    for (auto &index : index_vec) {
+        index = rng() % table_n_elements;
+    }
+
+    Kernel kernel_a;
+    Kernel kernel_b;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 + in1;");
+    kernel_b.add_input_port("in0");
+    kernel_b.add_input_port("in1");
+    kernel_b.add_output_port("out0");
+    kernel_b.set_compute_kernel("out0 = in0 * in1;");
+
+    std::vector<std::vector<uint32_t>> outs;
+    std::vector<size_t> bytes;
+    for (uint32_t chunk_tiles : {0U, 4U, 5U}) {
+        GatherStream gather_stream(table, table_n_elements, index_vec, 2);
+        Stream source1(in0, count);
+        Stream sink(std::vector<uint32_t>((count + 1) / 2, 0), count);
+        CpuMap map({&kernel_a, &kernel_b}, {&gather_stream, &source1, &sink});
+        map.add_connection(&gather_stream, &kernel_a, "in0");
+        map.add_connection(&kernel_a, "out0", &kernel_b, "in0");
+        map.add_connection(&source1, &kernel_b, "in1");
+        map.add_connection(&kernel_b, "out0", &sink);
+        map.set_fusion(false);
+        map.set_chunk_tiles(chunk_tiles);
+        map.execute();
+        outs.push_back(map.read_stream(&sink));
+        bytes.push_back(map.buffer_bytes());
+    }
+    EXPECT_EQ(outs[0], outs[1]);
+    EXPECT_EQ(outs[0], outs[2]);
+    // Two slots of: 4 tiles of indices (2 per token), 4 tiles of source data, two kernel outputs.
+    EXPECT_EQ(bytes[1], 2 * (4 * 1024 * 2 * 4 + 3 * 4 * 1024 * 2));
+    // Unchunked, only kernel_a's output needs a buffer (38 tiles); kernel_b's goes straight into the sink.
+    EXPECT_EQ(bytes[0], 38 * 1024 * 2);
+    for (size_t i = 0; i < count; i++) {
+        float sum = round_bf16(at(table, index_vec[i * 2]) + at(table, index_vec[i * 2 + 1]));
+        ASSERT_EQ(round_bf16(sum * at(in0, i)), at(outs[0], i)) << "i = " << i;
+    }
+}
+
+TEST(CpuMapTests, UnchunkedWritesSinkInPlace) {
+    // Odd, so the last sink word is shared with the word past the end of the stream.
+    uint32_t count = 1024 * 6 + 5;
+    auto in0 = random_bf16(count, 10.0F, 45);
+    std::vector<uint32_t> output((count + 1) / 2, 0xABCD0000U);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 * 2.0;");
+
+    Stream source0(in0, count);
+    Stream sink(output, count);
+    CpuMap map({&kernel_a}, {&source0, &sink});
+    map.add_connection(&source0, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &sink);
+    map.execute();
+
+    // Sources are read in place and the output is written into the sink: no full-size buffer at all.
+    EXPECT_EQ(map.buffer_bytes(), 0);
+    auto out = map.read_stream(&sink);
+    for (size_t i = 0; i < count; i++) {
+        ASSERT_EQ(round_bf16(at(in0, i) * 2.0F), at(out, i)) << "i = " << i;
+    }
+    EXPECT_EQ(out.back() & 0xFFFF0000U, 0xABCD0000U);
+}
+
+TEST(CpuMapTests, VariableArityGather) {
+    // 1D box filter without padding: edge tokens have two taps, interior tokens three.
+    uint32_t n = 1024 * 9 + 7;
+    auto table = random_bf16(n, 10.0F, 50);
+    std::vector<uint32_t> offsets = {0};
+    std::vector<uint32_t> index_vec;
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = i == 0 ? 0 : i - 1; j <= std::min(i + 1, n - 1); j++) {
+            index_vec.push_back(j);
+        }
+        offsets.push_back(static_cast<uint32_t>(index_vec.size()));
+    }
+    EXPECT_EQ(index_vec.size(), 3 * n - 2);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = (in0 + in1 + in2) / count;");
+
+    std::vector<std::vector<uint32_t>> outs;
+    for (uint32_t chunk_tiles : {0U, 2U}) {
+        GatherStream gather_stream(table, n, offsets, index_vec);
+        EXPECT_TRUE(gather_stream.variable_arity());
+        EXPECT_EQ(gather_stream.max_arity(), 3);
+        Stream sink(std::vector<uint32_t>((n + 1) / 2, 0), n);
+        CpuMap map({&kernel_a}, {&gather_stream, &sink});
+        map.add_connection(&gather_stream, &kernel_a, "in0");
+        map.add_connection(&kernel_a, "out0", &sink);
+        map.set_chunk_tiles(chunk_tiles);
+        map.execute();
+        outs.push_back(map.read_stream(&sink));
+    }
+    EXPECT_EQ(outs[0], outs[1]);
+    for (uint32_t i = 0; i < n; i++) {
+        float sum = 0.0F;
+        for (uint32_t k = offsets[i]; k < offsets[i + 1]; k++) {
+            sum = round_bf16(sum + at(table, index_vec[k]));
+        }
+        float expected = round_bf16(sum / static_cast<float>(offsets[i + 1] - offsets[i]));
+        ASSERT_NEAR(expected, at(outs[0], i), std::abs(expected) * 0.01F + 0.01F) << "i = " << i;
+    }
+
+    std::vector<uint32_t> three(3);
+    EXPECT_THROW(GatherStream(table, n, std::vector<uint32_t>{0, 2, 1, 3}, three), std::invalid_argument);
+    EXPECT_THROW(GatherStream(table, n, std::vector<uint32_t>{0, 2}, three), std::invalid_argument);
+}
+
+TEST(CpuMapTests, VariableArityGatherBesideLongerStream) {
+    // Chunks past the end of the short CSR gather still run for the longer plain stream's stage.
+    uint32_t n = 1024 + 3;
+    uint32_t long_n = 1024 * 8;
+    auto table = random_bf16(n, 10.0F, 51);
+    std::vector<uint32_t> offsets = {0};
+    std::vector<uint32_t> index_vec;
+    for (uint32_t i = 0; i < n; i++) {
+        index_vec.push_back(i);
+        offsets.push_back(static_cast<uint32_t>(index_vec.size()));
+    }
+    auto long_data = random_bf16(long_n, 10.0F, 52);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 * count;");
+    Kernel kernel_b;
+    kernel_b.add_input_port("in0");
+    kernel_b.add_output_port("out0");
+    kernel_b.set_compute_kernel("out0 = in0 * 2.0;");
+
+    GatherStream gather_stream(table, n, offsets, index_vec);
+    Stream long_stream(long_data, long_n);
+    Stream sink_a(std::vector<uint32_t>((n + 1) / 2, 0), n);
+    Stream sink_b(std::vector<uint32_t>(long_n / 2, 0), long_n);
+    CpuMap map({&kernel_a, &kernel_b}, {&gather_stream, &long_stream, &sink_a, &sink_b});
+    map.add_connection(&gather_stream, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &sink_a);
+    map.add_connection(&long_stream, &kernel_b, "in0");
+    map.add_connection(&kernel_b, "out0", &sink_b);
+    map.set_chunk_tiles(1);
+    map.execute();
+
+    auto out_a = map.read_stream(&sink_a);
+    auto out_b = map.read_stream(&sink_b);
+    for (uint32_t i = 0; i < n; i++) {
+        ASSERT_EQ(at(table, i), at(out_a, i)) << "i = " << i;
+    }
+    for (uint32_t i = 0; i < long_n; i++) {
+        ASSERT_EQ(at(long_data, i) * 2.0F, at(out_b, i)) << "i = " << i;
+    }
+}
+
+TEST(CpuMapTests, StencilBoundaries) {
+    // Odd dimensions so neither rows nor the image end on a tile boundary.
+    uint32_t width = 67;
+    uint32_t height = 45;
+    uint32_t n = width * height;
+    auto image = random_bf16(n, 10.0F, 60);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 + in1 + in2 + in3 + in4 + in5 + in6 + in7 + in8;");
+
+    auto pixel = [&](int64_t x, int64_t y, Boundary boundary) {
+        int64_t w = width;
+        int64_t h = height;
+        switch (boundary) {
+            case Boundary::Clamp:
+                return at(image, std::clamp<int64_t>(y, 0, h - 1) * w + std::clamp<int64_t>(x, 0, w - 1));
+            case Boundary::Zero: return x < 0 || x >= w || y < 0 || y >= h ? 0.0F : at(image, y * w + x);
+            case Boundary::Wrap: return at(image, (y + h) % h * w + (x + w) % w);
+        }
+        return 0.0F;
+    };
+    for (auto boundary : {Boundary::Clamp, Boundary::Zero, Boundary::Wrap}) {
+        for (uint32_t chunk_tiles : {0U, 1U}) {
+            StencilStream stencil(image, width, height, StencilStream::box(1), boundary);
+            EXPECT_EQ(stencil.taps(), 9);
+            Stream sink(std::vector<uint32_t>((n + 1) / 2, 0), n);
+            CpuMap map({&kernel_a}, {&stencil, &sink});
+            map.add_connection(&stencil, &kernel_a, "in0");
+            map.add_connection(&kernel_a, "out0", &sink);
+            map.set_chunk_tiles(chunk_tiles);
+            map.execute();
+            auto out = map.read_stream(&sink);
+            for (uint32_t y = 0; y < height; y++) {
+                for (uint32_t x = 0; x < width; x++) {
+                    float expected = 0.0F;
+                    for (int dy = -1; dy <= 1; dy++) {
+                        for (int dx = -1; dx <= 1; dx++) {
+                            expected = round_bf16(expected + pixel(int64_t{x} + dx, int64_t{y} + dy, boundary));
+                        }
+                    }
+                    ASSERT_NEAR(expected, at(out, y * width + x), std::abs(expected) * 0.02F + 0.05F)
+                        << "x = " << x << ", y = " << y << ", boundary = " << static_cast<int>(boundary);
+                }
+            }
+        }
+    }
+
+    EXPECT_THROW(StencilStream(image, width, height + 1, StencilStream::row(1)), std::invalid_argument);
+    EXPECT_THROW(StencilStream(image, width, height, {}), std::invalid_argument);
+}
+
+TEST(CpuMapTests, StencilMatchesExplicitGather) {
+    // The clamped horizontal box filter of the BoxFilter e2e test, with and without an index buffer.
+    uint32_t width = 300;
+    uint32_t height = 20;
+    uint32_t n = width * height;
+    auto image = random_bf16(n, 10.0F, 61);
+    StencilStream stencil(image, width, height, StencilStream::row(1), Boundary::Clamp);
+    std::vector<uint32_t> index_vec;
+    for (uint32_t t = 0; t < n; t++) {
+        for (uint32_t j = 0; j < stencil.taps(); j++) {
+            index_vec.push_back(static_cast<uint32_t>(stencil.neighbor(t, j)));
+        }
+    }
+    GatherStream gather(image, n, index_vec, 3);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = (in0 + in1 + in2) / 3;");
+
+    std::vector<std::vector<uint32_t>> outs;
+    for (Stream *source : std::vector<Stream *>{&stencil, &gather}) {
+        Stream sink(std::vector<uint32_t>((n + 1) / 2, 0), n);
+        CpuMap map({&kernel_a}, {source, &sink});
+        map.add_connection(source, &kernel_a, "in0");
+        map.add_connection(&kernel_a, "out0", &sink);
+        map.execute();
+        outs.push_back(map.read_stream(&sink));
+    }
+    EXPECT_EQ(outs[0], outs[1]);
+    EXPECT_EQ(index_vec[0], 0);
+    EXPECT_EQ(index_vec[3 * width - 1], width - 1);
+}
+
+TEST(CpuMapTests, ScatterOps) {
+    // Many duplicates: 5000 tokens over 37 destinations, with chunks so duplicates span chunk boundaries.
+    uint32_t n = 5000;
+    uint32_t table_n_elements = 37;
+    auto values = random_bf16(n, 10.0F, 80);
+    auto initial = random_bf16(table_n_elements, 10.0F, 81);
+    std::mt19937 rng(82);
+    std::vector<uint32_t> index_vec(n);
+    for (auto &index : index_vec) {
+        index = rng() % table_n_elements;
+    }
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+
+    for (auto op : {ScatterOp::Overwrite, ScatterOp::Add, ScatterOp::Max, ScatterOp::Min}) {
+        std::vector<float> expected(table_n_elements);
+        for (uint32_t i = 0; i < table_n_elements; i++) {
+            expected[i] = at(initial, i);
+        }
+        for (uint32_t t = 0; t < n; t++) {
+            float &dst = expected[index_vec[t]];
+            float value = at(values, t);
+            dst = op == ScatterOp::Overwrite ? value
+                  : op == ScatterOp::Add     ? dst + value
+                  : op == ScatterOp::Max     ? std::max(dst, value)
+                                             : std::min(dst, value);
+        }
+        for (uint32_t chunk_tiles : {0U, 1U}) {
+            Stream source(values, n);
+            ScatterStream scatter(initial, table_n_elements, index_vec, op);
+            CpuMap map({&kernel_a}, {&source, &scatter});
+            map.add_connection(&source, &kernel_a, "in0");
+            map.add_connection(&kernel_a, "out0", &scatter);
+            map.set_chunk_tiles(chunk_tiles);
+            map.execute();
+            auto out = map.read_stream(&scatter);
+            ASSERT_EQ(out.size(), (table_n_elements + 1) / 2);
+            for (uint32_t i = 0; i < table_n_elements; i++) {
+                // Add rounds once, from the fp32 sum.
+                ASSERT_EQ(round_bf16(expected[i]), at(out, i))
+                    << "i = " << i << ", op = " << static_cast<int>(op) << ", chunk_tiles = " << chunk_tiles;
+            }
+        }
+    }
+}
+
+TEST(CpuMapTests, ScatterHistogram) {
+    // Count tokens per bucket, then again after rebinding a zeroed table: counts land exactly.
+    uint32_t n = 4096;
+    uint32_t buckets = 16;
+    std::vector<uint32_t> ones((n + 1) / 2, 0x3F803F80U);
+    std::vector<uint32_t> index_vec(n);
+    for (uint32_t t = 0; t < n; t++) {
+        index_vec[t] = (t * 7) % buckets;
+    }
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    Stream source(ones, n);
+    std::vector<uint32_t> zeros(buckets / 2, 0);
+    ScatterStream histogram(zeros, buckets, index_vec, ScatterOp::Add);
+    EXPECT_EQ(histogram.size(), n);
+    EXPECT_EQ(histogram.table_size(), buckets);
+    CpuMap map({&kernel_a}, {&source, &histogram});
+    map.add_connection(&source, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &histogram);
+    for (float expected : {256.0F, 512.0F}) {
+        map.execute();
+        auto out = map.read_stream(&histogram);
+        for (uint32_t b = 0; b < buckets; b++) {
+            EXPECT_EQ(at(out, b), expected) << "b = " << b;
+        }
+    }
+    map.rebind(&histogram, zeros);
+    map.execute();
+    EXPECT_EQ(at(map.read_stream(&histogram), 0), 256.0F);
+
+    EXPECT_THROW(map.rebind(&histogram, std::vector<uint32_t>(1)), std::invalid_argument);
+    EXPECT_THROW(ScatterStream(zeros, buckets, std::vector<uint32_t>{buckets}), std::invalid_argument);
+}
+
+TEST(CpuMapTests, Reductions) {
+    uint32_t n = 1024 * 13 + 77;
+    auto values = random_bf16(n, 10.0F, 90);
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+
+    // Groups straddle tiles, chunks and cores; the last one is short.
+    uint32_t group_size = 1000;
+    uint32_t num_groups = (n + group_size - 1) / group_size;
+    for (auto op : {ReduceOp::Sum, ReduceOp::Min, ReduceOp::Max, ReduceOp::Mean, ReduceOp::ArgMax}) {
+        std::vector<double> expected(num_groups);
+        std::vector<uint32_t> expected_index(num_groups, 0);
+        for (uint32_t g = 0; g < num_groups; g++) {
+            uint32_t begin = g * group_size;
+            uint32_t end = std::min(n, begin + group_size);
+            double sum = 0.0;
+            double min = at(values, begin);
+            double max = at(values, begin);
+            for (uint32_t t = begin; t < end; t++) {
+                sum += at(values, t);
+                min = std::min<double>(min, at(values, t));
+                if (at(values, t) > max) {
+                    max = at(values, t);
+                    expected_index[g] = t - begin;
+                }
+            }
+            expected[g] = op == ReduceOp::Sum    ? sum
+                          : op == ReduceOp::Mean ? sum / (end - begin)
+                          : op == ReduceOp::Min  ? min
+                                                 : max;
+        }
+        for (uint32_t chunk_tiles : {0U, 3U}) {
+            Stream source(values, n);
+            ReduceStream reduce(op, n, group_size);
+            EXPECT_EQ(reduce.num_groups(), num_groups);
+            CpuMap map({&kernel_a}, {&source, &reduce});
+            map.add_connection(&source, &kernel_a, "in0");
+            map.add_connection(&kernel_a, "out0", &reduce);
+            map.set_chunk_tiles(chunk_tiles);
+            map.set_parallelization(5);
+            // Twice: partials start over on every execution.
+            map.execute();
+            map.execute();
+            ASSERT_EQ(reduce.values().size(), num_groups);
+            auto packed = map.read_stream(&reduce);
+            for (uint32_t g = 0; g < num_groups; g++) {
+                EXPECT_NEAR(reduce.values()[g], expected[g], 0.05) << "g = " << g << ", op = " << static_cast<int>(op);
+                EXPECT_EQ(at(packed, g), round_bf16(reduce.values()[g]));
+                if (op == ReduceOp::ArgMax) {
+                    EXPECT_EQ(reduce.indices()[g], expected_index[g]) << "g = " << g;
+                }
+            }
+        }
+    }
+
+    // Default group: one scalar over every token.
+    Stream source(values, n);
+    ReduceStream total(ReduceOp::Sum, n);
+    CpuMap map({&kernel_a}, {&source, &total});
+    map.add_connection(&source, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &total);
+    map.execute();
+    ASSERT_EQ(total.values().size(), 1);
+    double sum = 0.0;
+    for (uint32_t t = 0; t < n; t++) {
+        sum += at(values, t);
+    }
+    EXPECT_NEAR(total.values()[0], sum, 0.5);
+}
+
+TEST(CpuMapTests, ScanStream) {
+    // Small integers keep the fp32 carries exact, so outputs are the exact sums rounded once to bf16.
+    uint32_t n = 1024 * 13 + 77;
+    std::vector<float> values(n);
+    std::mt19937 rng(91);
+    for (auto &value : values) {
+        value = static_cast<float>(rng() % 4);
+    }
+    auto packed = pack_bf16_vec(values);
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+
+    for (auto kind : {ScanKind::Inclusive, ScanKind::Exclusive}) {
+        for (uint32_t chunk_tiles : {0U, 3U}) {
+            Stream source(packed, n);
+            ScanStream scan(std::vector<uint32_t>((n + 1) / 2, 0), n, kind);
+            CpuMap map({&kernel_a}, {&source, &scan});
+            map.add_connection(&source, &kernel_a, "in0");
+            map.add_connection(&kernel_a, "out0", &scan);
+            map.set_chunk_tiles(chunk_tiles);
+            map.set_parallelization(5);
+            // Twice: the carry starts over on every execution.
+            map.execute();
+            map.execute();
+            auto out = map.read_stream(&scan);
+            float running = 0.0F;
+            for (uint32_t i = 0; i < n; i++) {
+                float expected = kind == ScanKind::Inclusive ? running + values[i] : running;
+                running += values[i];
+                ASSERT_EQ(at(out, i), round_bf16(expected))
+                    << "i = " << i << ", kind = " << static_cast<int>(kind) << ", chunk_tiles = " << chunk_tiles;
+            }
+        }
+    }
+}
+
+TEST(CpuMapTests, ExecutionStats) {
+    uint32_t count = 1024 * 64 + 3;
+    uint32_t table_size = 4096;
+    auto in0 = random_bf16(count, 10.0F, 40);
+    auto table = random_bf16(table_size, 10.0F, 41);
+    std::vector<uint32_t> indices(count * 2);
+    for (size_t i = 0; i < indices.size(); i++) {
+        indices[i] = (i * 7) % table_size;
+    }
+    std::vector<uint32_t> output((count + 1) / 2, 0);
+
+    Kernel kernel;
+    kernel.add_input_port("in0");
+    kernel.add_input_port("in1");
+    kernel.add_output_port("out0");
+    kernel.set_compute_kernel("out0 = in0 + in1;");
+
+    Stream source(in0, count);
+    GatherStream gather(table, table_size, indices, 2);
+    Stream sink(output, count);
+
+    CpuMap map({&kernel}, {&source, &gather, &sink});
+    map.add_connection(&source, &kernel, "in0");
+    map.add_connection(&gather, &kernel, "in1");
+    map.add_connection(&kernel, "out0", &sink);
+    map.set_chunk_tiles(16);
+
+    for (int run = 0; run < 2; run++) {
+        auto stats = map.execute();
+        // Compiled on the first call only.
+        EXPECT_EQ(stats.generation == ExecutionStats::Duration::zero(), run == 1);
+        EXPECT_EQ(stats.compilation, ExecutionStats::Duration::zero());
+        EXPECT_GT(stats.device, ExecutionStats::Duration::zero());
+        EXPECT_GT(stats.host_to_device, ExecutionStats::Duration::zero());
+        EXPECT_GT(stats.readback, ExecutionStats::Duration::zero());
+        EXPECT_GE(stats.total, stats.device);
+
+        ASSERT_EQ(stats.streams.size(), 3);
+        EXPECT_EQ(stats.streams[0].stream, &source);
+        EXPECT_EQ(stats.streams[0].bytes, (count + 1) / 2 * 4);
+        EXPECT_EQ(stats.streams[1].bytes, (table.size() + indices.size()) * 4);
+        EXPECT_EQ(stats.streams[2].bytes, (count + 1) / 2 * 4);
+        EXPECT_EQ(stats.bytes(), stats.streams[0].bytes + stats.streams[1].bytes + stats.streams[2].bytes);
+        EXPECT_GT(stats.gbps(), 0.0);
+        EXPECT_NEAR(stats.streams[1].gbps, gbps(stats.streams[1].bytes, stats.total), 1e-9);
+        EXPECT_NE(stats.describe().find("host->device"), std::string::npos);
+    }
+}
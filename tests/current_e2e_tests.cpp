@@ -10,6 +10,8 @@
 #include "common/bfloat16.hpp"
 #include "common/logger.hpp"
 #include "common/tt_backend_api_types.hpp"
+#include "host/bf16.hpp"
+#include "host/compare.hpp"
 #include "map.hpp"
 #include "stream.hpp"
 
@@ -72,24 +74,20 @@ TEST(CurrentTests, B16EltwiseSAXPY) {
 
     // Validate output.
     auto out = map.read_stream(&sink);
-    auto out_bf16 = unpack_uint32_vec_into_bfloat16_vec(out);
-    EXPECT_EQ(out_bf16.size(), TILE_SIZE * n_tiles);
-    // for (size_t i = 0; i < out_bf16.size(); i++) {
-    //     std::cout << i << ": " << out_bf16[i].to_float() << "\n";
-    // }
-    // std::cout << "\n";
+    EXPECT_EQ(out.size() * 2, TILE_SIZE * n_tiles);
 
-    auto in0 = unpack_uint32_vec_into_bfloat16_vec(generator0_data);
-    auto in1 = unpack_uint32_vec_into_bfloat16_vec(generator1_data);
-    bool pass = true;
-    for (size_t i = 0; i < out_bf16.size(); i++) {
+    auto in0 = current::host::unpack_bf16_vec(generator0_data);
+    auto in1 = current::host::unpack_bf16_vec(generator1_data);
+    std::vector<float> expected(out.size() * 2);
+    for (size_t i = 0; i < expected.size(); i++) {
         // Check that out[i] = in0[i] * 2.0 + in1[i]
-        auto expected = bfloat16(in0[i].to_float() * 2.0F + in1[i].to_float());
-        // auto expected = bfloat16(in0[i].to_float() * 2.0F);
-        // auto expected = bfloat16(2.0F);
-        pass &= is_close(expected.to_float(), out_bf16[i].to_float());
+        expected[i] = in0[i] * 2.0F + in1[i];
     }
-    EXPECT_TRUE(pass);
+    auto result = current::host::compare_bf16(expected, out, expected.size());
+    if (!result.passed()) {
+        std::cout << result.summary();
+    }
+    EXPECT_TRUE(result.passed());
 }
 
 TEST(CurrentTests, STREAM_COPY) {
@@ -149,16 +147,14 @@ TEST(CurrentTests, STREAM_COPY) {
         auto duration = map.execute();
 
         // Validate output.
-        auto a_out = unpack_uint32_vec_into_bfloat16_vec(map.read_stream(&sink));
-        EXPECT_EQ(a_out.size(), TILE_SIZE * n_tiles);
-
-        auto b_in = unpack_uint32_vec_into_bfloat16_vec(b_initial_data);
-        bool pass = true;
-        for (size_t i = 0; i < sink.size(); i++) {
-            auto expected = b_in[i];
-            pass &= is_close(expected.to_float(), a_out[i].to_float());
+        auto a_out = map.read_stream(&sink);
+        EXPECT_EQ(a_out.size() * 2, TILE_SIZE * n_tiles);
+
+        auto result = current::host::compare_bf16(b_initial_data, a_out, sink.size());
+        if (!result.passed()) {
+            std::cout << result.summary();
         }
-        EXPECT_TRUE(pass);
+        EXPECT_TRUE(result.passed());
         durations[n] = duration;
     }
 }
@@ -222,18 +218,18 @@ TEST(CurrentTests, STREAM_SCALE) {
         auto duration = map.execute();
 
         // Validate output.
-        auto a_out = unpack_uint32_vec_into_bfloat16_vec(map.read_stream(&sink));
-        EXPECT_EQ(a_out.size(), TILE_SIZE * n_tiles);
-
-        auto b_in = unpack_uint32_vec_into_bfloat16_vec(b_initial_data);
-        bool pass = true;
-        for (size_t i = 0; i < sink.size(); i++) {
-            // std::cout << "in: " << b_in[i].to_float();
-            // std::cout << "out: " << a_out[i].to_float();
-            auto expected = bfloat16(b_in[i].to_float() * SCALAR);
-            pass &= is_close(expected.to_float(), a_out[i].to_float());
+        auto a_out = map.read_stream(&sink);
+        EXPECT_EQ(a_out.size() * 2, TILE_SIZE * n_tiles);
+
+        auto b_in = current::host::unpack_bf16_vec(b_initial_data);
+        for (auto &value : b_in) {
+            value *= SCALAR;
+        }
+        auto result = current::host::compare_bf16(b_in, a_out, sink.size());
+        if (!result.passed()) {
+            std::cout << result.summary();
         }
-        EXPECT_TRUE(pass);
+        EXPECT_TRUE(result.passed());
         durations[n] = duration;
     }
 }
@@ -11,6 +11,8 @@
 #include "common.hpp"
 #include "common/bfloat16.hpp"
 #include "common/tt_backend_api_types.hpp"
+#include "host/bf16.hpp"
+#include "host/compare.hpp"
 #include "map.hpp"
 #include "stream.hpp"
 
@@ -63,20 +65,12 @@ TEST(CurrentTests, Pipeline) {
     map.execute();
 
     // Validate output.
-    auto in = unpack_uint32_vec_into_bfloat16_vec(generator0_data);
     auto out = map.read_stream(&sink);
-    auto out_b16_vec = unpack_uint32_vec_into_bfloat16_vec(out);
-
-    bool pass = true;
-    for (size_t i = 0; i < count; i++) {
-        bool close = is_close(in[i].to_float(), out_b16_vec[i].to_float());
-        if (!close) {
-            std::cout << i << ": in = " << in[i].to_float() << ", out = " << out_b16_vec[i].to_float() << "\n";
-            std::cout << "\n";
-        }
-        pass &= close;
+    auto result = current::host::compare_bf16(generator0_data, out, count);
+    if (!result.passed()) {
+        std::cout << result.summary();
     }
-    EXPECT_TRUE(pass);
+    EXPECT_TRUE(result.passed());
 }
 
 TEST(CurrentTests, GatherTest) {
@@ -144,24 +138,18 @@ TEST(CurrentTests, GatherTest) {
 
     // Validate output.
     auto in_raw = map.read_gather_stream(&gather_stream, true);
-    auto in = unpack_uint32_vec_into_bfloat16_vec(in_raw);
+    auto in = current::host::unpack_bf16_vec(in_raw);
     auto out = map.read_stream(&sink);
-    auto out_b16_vec = unpack_uint32_vec_into_bfloat16_vec(out);
 
-    bool pass = true;
+    std::vector<float> expected(num_indices);
     for (size_t i = 0; i < num_indices; i++) {
-        auto index = index_vec[i] * 16;
-        std::cout << std::dec;  // Force decimal output
-        // std::cout << "i: " << i << ",Index: " << index << ", ";
-        auto input = in[index];
-        // std::cout << "in[" << index << "] = " << input.to_float() << ", ";
-        auto output = out_b16_vec[i];
-        // std::cout << "out: " << out_b16_vec[i].to_float() << "\n";
-
-        pass &= is_close(input.to_float(), output.to_float());
-        // std::cout << "\n";
+        expected[i] = in[index_vec[i] * 16];
     }
-    EXPECT_TRUE(pass);
+    auto result = current::host::compare_bf16(expected, out, num_indices);
+    if (!result.passed()) {
+        std::cout << result.summary();
+    }
+    EXPECT_TRUE(result.passed());
 }
 
 TEST(CurrentTests, GatherTestSRAM) {
@@ -230,24 +218,18 @@ TEST(CurrentTests, GatherTestSRAM) {
     std::cout << "Finished!\n";
 
     // Validate output.
-    auto in = unpack_uint32_vec_into_bfloat16_vec(data_buffer);
+    auto in = current::host::unpack_bf16_vec(data_buffer);
     auto out = map.read_stream(&sink);
-    auto out_b16_vec = unpack_uint32_vec_into_bfloat16_vec(out);
 
-    bool pass = true;
+    std::vector<float> expected(num_indices);
     for (size_t i = 0; i < num_indices; i++) {
-        auto index = index_vec[i];  // Since we're using SRAM, don't have to scale accesses.
-        std::cout << std::dec;      // Force decimal output
-        // std::cout << "i: " << i << ",Index: " << index << ", ";
-        auto input = in[index];
-        // std::cout << "in[" << index << "] = " << input.to_float() << ", ";
-        auto output = out_b16_vec[i];
-        // std::cout << "out: " << out_b16_vec[i].to_float() << "\n";
-
-        pass &= is_close(input.to_float(), output.to_float());
-        // std::cout << "\n";
+        expected[i] = in[index_vec[i]];  // Since we're using SRAM, don't have to scale accesses.
+    }
+    auto result = current::host::compare_bf16(expected, out, num_indices);
+    if (!result.passed()) {
+        std::cout << result.summary();
     }
-    EXPECT_TRUE(pass);
+    EXPECT_TRUE(result.passed());
 }
 
 TEST(CurrentTests, GatherTestMultipleAccesses) {
@@ -338,39 +320,22 @@ TEST(CurrentTests, GatherTestMultipleAccesses) {
 
     std::cout << "Finished!\n";
 
-    // Validate output
+    // Validate output.
     auto in_raw = map.read_gather_stream(&gather_stream, true);
-    auto in = unpack_uint32_vec_into_bfloat16_vec(in_raw);
+    auto in = current::host::unpack_bf16_vec(in_raw);
     auto out = map.read_stream(&sink);
-    auto out_b16_vec = unpack_uint32_vec_into_bfloat16_vec(out);
-    std::cout << "Out size: " << out_b16_vec.size() << "\n";
 
-    bool pass = true;
-    // Since we have 2 accesses per token, we'll process indices in pairs
-    // and output_size will be num_indices/2
-    for (size_t i = 0; i < num_indices / accesses_per_token; i++) {
-        // Get the two indices for this token
-        auto index1 = index_vec[i * accesses_per_token] * 16;
-        auto index2 = index_vec[i * accesses_per_token + 1] * 16;
-
-        std::cout << std::dec;  // Force decimal output
-        auto input1 = in[index1];
-        auto input2 = in[index2];
-        auto output = out_b16_vec[i];
-
-        // Expected output is average of the two gathered values
-        // float expected = (input1.to_float() + input2.to_float()) * 0.5f;
-        float expected = input1.to_float();
-
-        std::cout << "Token " << i << ": "
-                  << "index1=" << index1 << " val1=" << input1.to_float() << ", "
-                  << "index2=" << index2 << " val2=" << input2.to_float() << ", "
-                  << "expected=" << expected << ", "
-                  << "got=" << output.to_float() << "\n";
-
-        pass &= is_close(expected, output.to_float());
+    // Each token's output is its first gathered value.
+    size_t num_tokens = num_indices / accesses_per_token;
+    std::vector<float> expected(num_tokens);
+    for (size_t i = 0; i < num_tokens; i++) {
+        expected[i] = in[index_vec[i * accesses_per_token] * 16];
     }
-    EXPECT_TRUE(pass);
+    auto result = current::host::compare_bf16(expected, out, num_tokens);
+    if (!result.passed()) {
+        std::cout << result.summary();
+    }
+    EXPECT_TRUE(result.passed());
 }
 
 TEST(CurrentTests, GatherTestMultipleAccessesSRAM) {
@@ -462,38 +427,21 @@ TEST(CurrentTests, GatherTestMultipleAccessesSRAM) {
 
     std::cout << "Finished!\n";
 
-    // Validate output
-    // auto in_raw = map.read_gather_stream(&gather_stream, true);
-    auto in = unpack_uint32_vec_into_bfloat16_vec(data_buffer);
+    // Validate output.
+    auto in = current::host::unpack_bf16_vec(data_buffer);
     auto out = map.read_stream(&sink);
-    auto out_b16_vec = unpack_uint32_vec_into_bfloat16_vec(out);
 
-    bool pass = true;
-    // Since we have 2 accesses per token, we'll process indices in pairs
-    // and output_size will be num_indices/2
-    std::cout << "Checking output...\n";
-    for (size_t i = 0; i < num_indices / accesses_per_token; i++) {
-        // Get the two indices for this token
-        auto index1 = index_vec[i * accesses_per_token];
-        auto index2 = index_vec[i * accesses_per_token + 1];
-
-        std::cout << std::dec;  // Force decimal output
-        auto input1 = in[index1];
-        auto input2 = in[index2];
-        auto output = out_b16_vec[i];
-
-        // Expected output is average of the two gathered values
-        float expected = (input1.to_float() + input2.to_float()) * 0.5f;
-
-        std::cout << "Token " << i << ": "
-                  << "index1=" << index1 << " val1=" << input1.to_float() << ", "
-                  << "index2=" << index2 << " val2=" << input2.to_float() << ", "
-                  << "expected=" << expected << ", "
-                  << "got=" << output.to_float() << "\n";
-
-        pass &= is_close(expected, output.to_float());
+    // Each token's output is the average of its two gathered values.
+    size_t num_tokens = num_indices / accesses_per_token;
+    std::vector<float> expected(num_tokens);
+    for (size_t i = 0; i < num_tokens; i++) {
+        expected[i] = (in[index_vec[i * accesses_per_token]] + in[index_vec[i * accesses_per_token + 1]]) * 0.5F;
+    }
+    auto result = current::host::compare_bf16(expected, out, num_tokens);
+    if (!result.passed()) {
+        std::cout << result.summary();
     }
-    EXPECT_TRUE(pass);
+    EXPECT_TRUE(result.passed());
 
     // // Validate output.
     // auto in_raw = map.read_gather_stream(&gather_stream, true);
@@ -0,0 +1,144 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "host/expr.hpp"
+
+using namespace current::host::expr;
+
+namespace {
+
+const std::vector<std::string> kInputs = {"in0", "in1", "in2"};
+const std::vector<std::string> kOutputs = {"out0"};
+
+}  // namespace
+
+TEST(ExprTests, BoxFilterSchedule) {
+    auto program = compile("out0 = (in0 + in1 + in2) * 0.33;", kInputs, kOutputs);
+    EXPECT_EQ(program.arithmetic_ops(), 3);
+
+    auto sched = schedule(program);
+    auto counts = sched.counts();
+    // add_tiles(in0, in1) on the FPU, one copy for in2, two SFPU ops, one pack.
+    EXPECT_EQ(counts.fpu, 1);
+    EXPECT_EQ(counts.copies, 1);
+    EXPECT_EQ(counts.sfpu, 2);
+    EXPECT_EQ(counts.packs, 1);
+    EXPECT_EQ(sched.dest_registers, 2);
+}
+
+TEST(ExprTests, ConstantFolding) {
+    auto program = compile("out0 = in0 * (2.0 * 3.0 - 5.0) + (1.0 - 1.0);", kInputs, kOutputs);
+    // Folds to in0 * 1 + 0 == in0.
+    EXPECT_EQ(program.arithmetic_ops(), 0);
+    EXPECT_EQ(program.nodes[program.outputs[0]].op, Op::Input);
+}
+
+TEST(ExprTests, CommonSubexpressionElimination) {
+    auto program = compile("t = in0 + in1; out0 = (in1 + in0) * t;", kInputs, kOutputs);
+    EXPECT_EQ(program.arithmetic_ops(), 2);
+
+    Options no_opt{.fold_constants = false, .eliminate_common_subexpressions = false, .reduce_strength = false};
+    EXPECT_EQ(compile("t = in0 + in1; out0 = (in1 + in0) * t;", kInputs, kOutputs, no_opt).arithmetic_ops(), 3);
+}
+
+TEST(ExprTests, StrengthReduction) {
+    // Divide by a power of two becomes a multiply by the reciprocal.
+    auto div = compile("out0 = in0 / 4.0;", kInputs, kOutputs);
+    ASSERT_EQ(div.arithmetic_ops(), 1);
+    const auto &mul = div.nodes[div.outputs[0]];
+    EXPECT_EQ(mul.op, Op::Mul);
+    EXPECT_EQ(div.nodes[mul.rhs].value, 0.25F);
+    // Other divisors have no exact reciprocal, so the divide stays.
+    auto third = compile("out0 = in0 / 3.0;", kInputs, kOutputs);
+    EXPECT_EQ(third.nodes[third.outputs[0]].op, Op::Div);
+
+    // x * 2 becomes a single FPU add with no copies.
+    auto twice = schedule(compile("out0 = in0 * 2.0;", kInputs, kOutputs)).counts();
+    EXPECT_EQ(twice.fpu, 1);
+    EXPECT_EQ(twice.sfpu, 0);
+    EXPECT_EQ(twice.copies, 0);
+
+    // Power-of-two scale chains collapse into one scalar multiply.
+    auto chain = compile("out0 = in0 * 0.5 * 3.0;", kInputs, kOutputs);
+    EXPECT_EQ(chain.arithmetic_ops(), 1);
+
+    // x * -1 and 0 - x are negations.
+    EXPECT_EQ(compile("out0 = 0.0 - in0 * -1.0;", kInputs, kOutputs).arithmetic_ops(), 0);
+}
+
+TEST(ExprTests, DeadPortElimination) {
+    auto program = compile("unused = in1 * in2; out0 = in2 + 1.0;", kInputs, kOutputs);
+    EXPECT_EQ(program.arithmetic_ops(), 1);
+    EXPECT_EQ(program.live_inputs, (std::vector<bool>{false, false, true}));
+}
+
+TEST(ExprTests, SharedValueIsCopiedBeforeInPlaceOp) {
+    auto sched = schedule(compile("t = in0 * in1; out0 = t + 1.0; out1 = t;", kInputs, {"out0", "out1"}));
+    auto counts = sched.counts();
+    EXPECT_EQ(counts.fpu, 1);
+    EXPECT_EQ(counts.copies, 1);  // t is duplicated before the in-place add.
+    EXPECT_EQ(counts.sfpu, 1);
+    EXPECT_EQ(counts.packs, 2);
+    EXPECT_NE(sched.render().find("copy_dest_values"), std::string::npos);
+}
+
+TEST(ExprTests, EmptySourceIsPassthrough) {
+    auto program = compile("", kInputs, {"out0", "out1"});
+    EXPECT_EQ(program.outputs, (std::vector<uint32_t>{0, 0}));
+    EXPECT_EQ(schedule(program).counts().total(), 3);  // One copy, two packs.
+}
+
+TEST(ExprTests, Errors) {
+    EXPECT_THROW(compile("out0 = in7;", kInputs, kOutputs), std::invalid_argument);
+    EXPECT_THROW(compile("out0 = (in0 + in1;", kInputs, kOutputs), std::invalid_argument);
+    EXPECT_THROW(compile("t = in0;", kInputs, kOutputs), std::invalid_argument);
+    EXPECT_THROW(compile("out0 = in0 * 1e99;", kInputs, kOutputs), std::invalid_argument);
+    EXPECT_THROW(compile("out0 = in0 * 0x10;", kInputs, kOutputs), std::invalid_argument);
+    EXPECT_THROW(compile("out0 = in0 \xe9;", kInputs, kOutputs), std::invalid_argument);
+}
+
+TEST(ExprTests, FuseInlinesProducer) {
+    auto producer = compile("out0 = in0 * 2.0;", {"in0"}, kOutputs);
+    auto consumer = compile("out0 = in0 * 0.5;", {"in0"}, kOutputs);
+    // The scales cancel once both kernels are in one DAG.
+    auto fused = fuse(producer, 0, consumer, 0);
+    EXPECT_EQ(fused.arithmetic_ops(), 0);
+    EXPECT_EQ(fused.nodes[fused.outputs[0]].op, Op::Input);
+}
+
+TEST(ExprTests, FuseInputOrder) {
+    auto producer = compile("out0 = in0 - in1;", {"a", "b"}, kOutputs);
+    auto consumer = compile("out0 = in0 / in1;", {"x", "y"}, kOutputs);
+    // Consumer slot 1 reads the producer: inputs become {a, b, x}, out0 = x / (a - b).
+    auto fused = fuse(producer, 0, consumer, 1);
+    ASSERT_EQ(fused.live_inputs.size(), 3);
+    ASSERT_EQ(fused.arithmetic_ops(), 2);
+    const auto &div = fused.nodes[fused.outputs[0]];
+    ASSERT_EQ(div.op, Op::Div);
+    EXPECT_EQ(fused.nodes[div.lhs].op, Op::Input);
+    EXPECT_EQ(fused.nodes[div.lhs].input, 2);
+    EXPECT_EQ(fused.nodes[div.rhs].op, Op::Sub);
+}
+
+TEST(ExprTests, SerializeRoundTrip) {
+    auto program = compile("t = in0 * 0.1; out0 = t + in2; out1 = -t / in1;", kInputs, {"out0", "out1"});
+    auto copy = deserialize(serialize(program));
+    ASSERT_EQ(copy.nodes.size(), program.nodes.size());
+    for (size_t i = 0; i < program.nodes.size(); i++) {
+        EXPECT_EQ(copy.nodes[i].op, program.nodes[i].op);
+        EXPECT_EQ(copy.nodes[i].value, program.nodes[i].value);
+    }
+    EXPECT_EQ(copy.outputs, program.outputs);
+    EXPECT_EQ(copy.live_inputs, program.live_inputs);
+    EXPECT_EQ(schedule(copy).render(), schedule(program).render());
+
+    EXPECT_THROW(deserialize("program 2 1 1\n1 0 0 0 0\n"), std::invalid_argument);
+    EXPECT_THROW(deserialize("program 1 1 1\n2 0 0 0 0\n0\n1\n"), std::invalid_argument);
+}
@@ -0,0 +1,122 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "host/bf16.hpp"
+#include "host/cpu_map.hpp"
+#include "host/gather_plan.hpp"
+
+using namespace current::host;
+
+TEST(GatherPlanTests, PermutesWithinTiles) {
+    uint32_t table_n_elements = 1 << 20;
+    uint8_t accesses_per_token = 3;
+    uint32_t num_tokens = 1024 * 5 + 17;
+    std::mt19937 rng(1);
+    std::vector<uint32_t> index_vec(num_tokens * accesses_per_token);
+    for (auto &index : index_vec) {
+        index = rng() % table_n_elements;
+    }
+
+    DramGeometry geometry;
+    auto plan = plan_gather(index_vec, accesses_per_token, geometry);
+    ASSERT_EQ(plan.indices.size(), index_vec.size());
+    ASSERT_EQ(plan.read_offsets.size(), index_vec.size());
+    uint32_t tile_reads = GatherPlan::TILE_TOKENS * accesses_per_token;
+    for (uint32_t tile_first = 0; tile_first < index_vec.size(); tile_first += tile_reads) {
+        uint32_t n = std::min<uint32_t>(tile_reads, index_vec.size() - tile_first);
+        std::vector<bool> seen(n, false);
+        for (uint32_t slot = 0; slot < n; slot++) {
+            uint32_t offset = plan.read_offsets[tile_first + slot];
+            ASSERT_LT(offset, n);
+            EXPECT_FALSE(seen[offset]);
+            seen[offset] = true;
+            EXPECT_EQ(plan.indices[tile_first + slot], index_vec[tile_first + offset]);
+        }
+    }
+    EXPECT_EQ(plan.before.reads, plan.after.reads);
+    // Each tile's reads visit every bank once.
+    EXPECT_LT(plan.after.bank_switches, plan.before.bank_switches / 100);
+    EXPECT_LT(plan.after.page_switches, plan.before.page_switches);
+    EXPECT_THROW(plan_gather(index_vec, 2, geometry), std::invalid_argument);
+}
+
+TEST(GatherPlanTests, ReorderedGatherMatches) {
+    uint32_t table_n_elements = 1 << 16;
+    uint32_t num_tokens = 1024 * 6 + 100;
+    std::vector<uint32_t> table((table_n_elements + 1) / 2);
+    std::mt19937 rng(2);
+    for (uint32_t i = 0; i < table_n_elements; i++) {
+        table[i / 2] |= static_cast<uint32_t>(float_to_bf16(static_cast<float>(rng() % 1000))) << (16 * (i & 1));
+    }
+    std::vector<uint32_t> index_vec(num_tokens * 2);
+    for (auto &index : index_vec) {
+        index = rng() % table_n_elements;
+    }
+    std::vector<uint32_t> other((num_tokens + 1) / 2, 0x3F803F80U);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_input_port("in2");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 - in1 + in2;");
+
+    std::vector<std::vector<uint32_t>> outs;
+    for (uint32_t chunk_tiles : {0U, 0U, 2U}) {
+        GatherStream gather_stream(table, table_n_elements, index_vec, 2);
+        if (outs.size() > 0) {
+            gather_stream.reorder();
+            ASSERT_TRUE(gather_stream.plan().has_value());
+        }
+        Stream source(other, num_tokens);
+        Stream sink(std::vector<uint32_t>((num_tokens + 1) / 2, 0), num_tokens);
+        CpuMap map({&kernel_a}, {&gather_stream, &source, &sink});
+        map.add_connection(&gather_stream, &kernel_a, "in0");
+        map.add_connection(&source, &kernel_a, "in2");
+        map.add_connection(&kernel_a, "out0", &sink);
+        map.set_chunk_tiles(chunk_tiles);
+        map.execute();
+        outs.push_back(map.read_stream(&sink));
+    }
+    EXPECT_EQ(outs[0], outs[1]);
+    EXPECT_EQ(outs[0], outs[2]);
+}
+
+TEST(GatherPlanTests, PackedTableChunks) {
+    DramGeometry geometry;
+    // 16 bf16 elements per 32-byte chunk instead of one.
+    EXPECT_EQ(geometry.padded_bytes(1000), 32000);
+    EXPECT_EQ(geometry.packed_bytes(1000), 2016);
+    EXPECT_EQ(geometry.chunk_of(15), 0);
+    EXPECT_EQ(geometry.chunk_of(16), 1);
+
+    // Sequential reads fetch each chunk once; the same reads interleaved with a far index refetch every time.
+    std::vector<uint32_t> sequential(64);
+    std::vector<uint32_t> interleaved;
+    for (uint32_t i = 0; i < sequential.size(); i++) {
+        sequential[i] = i;
+        interleaved.push_back(i);
+        interleaved.push_back(1 << 20);
+    }
+    EXPECT_EQ(measure_locality(sequential, geometry).chunk_fetches, 4);
+    EXPECT_EQ(measure_locality(interleaved, geometry).chunk_fetches, interleaved.size());
+    EXPECT_EQ(measure_locality({}, geometry).chunk_fetches, 0);
+
+    // Reordering groups reads of the same chunk, so a random gather reuses chunks it would otherwise refetch.
+    std::mt19937 rng(3);
+    std::vector<uint32_t> index_vec(1024 * 4);
+    for (auto &index : index_vec) {
+        index = rng() % 4096;
+    }
+    auto plan = plan_gather(index_vec, 1, geometry);
+    EXPECT_LE(plan.after.chunk_fetches, 4 * 256);
+    EXPECT_GT(plan.before.chunk_fetches, 3 * plan.after.chunk_fetches);
+}
@@ -0,0 +1,186 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "host/cpu_map.hpp"
+#include "host/kernel_cache.hpp"
+
+using namespace current::host;
+
+namespace {
+
+// Fresh cache directory per test, removed afterwards.
+class KernelCacheTests : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() /
+              ("kernel_cache_test_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(dir);
+    }
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    std::filesystem::path dir;
+};
+
+}  // namespace
+
+TEST_F(KernelCacheTests, KeyIsFieldSensitive) {
+    EXPECT_EQ(CacheKey().add("ab").add(4).hex(), CacheKey().add("ab").add(4).hex());
+    EXPECT_NE(CacheKey().add("ab").add("c").hex(), CacheKey().add("a").add("bc").hex());
+    EXPECT_NE(CacheKey().add(1).hex(), CacheKey().add(2).hex());
+    EXPECT_EQ(CacheKey().hex().size(), 32);
+}
+
+TEST_F(KernelCacheTests, StoreAndLookup) {
+    KernelCache cache(dir);
+    auto key = CacheKey().add("kernel");
+    EXPECT_FALSE(cache.lookup(key).has_value());
+
+    CacheEntry entry;
+    entry.files["compute.cpp"] = "pack_tile(0, cb_out0);\n";
+    entry.files["bin/brisc.elf"] = std::string("\x7f" "ELF\0\1", 6);
+    cache.store(key, entry);
+
+    auto cached = cache.lookup(key);
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->files, entry.files);
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_EQ(cache.misses(), 1);
+
+    int builds = 0;
+    auto build = [&] {
+        builds++;
+        return entry;
+    };
+    cache.get_or_build(CacheKey().add("other"), build);
+    cache.get_or_build(CacheKey().add("other"), build);
+    EXPECT_EQ(builds, 1);
+}
+
+TEST_F(KernelCacheTests, StoreKeepsLiveEntry) {
+    KernelCache cache(dir);
+    auto key = CacheKey().add("kernel");
+    CacheEntry first;
+    first.files["compute.cpp"] = "first";
+    first.files["empty"] = "";
+    cache.store(key, first);
+
+    // A second store of the same key must not remove or rewrite the entry readers may be using.
+    CacheEntry second;
+    second.files["compute.cpp"] = "second";
+    cache.store(key, second);
+    auto cached = cache.lookup(key);
+    ASSERT_TRUE(cached.has_value());
+    EXPECT_EQ(cached->files, first.files);
+    EXPECT_EQ(std::distance(std::filesystem::directory_iterator(dir), std::filesystem::directory_iterator()), 1);
+}
+
+TEST_F(KernelCacheTests, CpuMapWarmStart) {
+    uint32_t count = 1024 * 4;
+    std::vector<uint32_t> in0(count / 2, 0x3F803F80U);  // 1.0, 1.0
+    std::vector<uint32_t> out(count / 2, 0);
+
+    Kernel kernel_a;
+    Kernel kernel_b;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 * 3.0;");
+    kernel_b.add_input_port("in0");
+    kernel_b.add_output_port("out0");
+    kernel_b.set_compute_kernel("out0 = in0 + 1.0;");
+
+    KernelCache cache(dir);
+    std::vector<std::vector<uint32_t>> results;
+    for (int run = 0; run < 2; run++) {
+        Stream source0(in0, count);
+        Stream sink(out, count);
+        CpuMap map({&kernel_a, &kernel_b}, {&source0, &sink});
+        map.add_connection(&source0, &kernel_a, "in0");
+        map.add_connection(&kernel_a, "out0", &kernel_b, "in0");
+        map.add_connection(&kernel_b, "out0", &sink);
+        map.set_kernel_cache(&cache);
+        map.execute();
+        results.push_back(map.read_stream(&sink));
+    }
+    EXPECT_EQ(cache.misses(), 1);
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_EQ(results[0], results[1]);
+    EXPECT_EQ(results[0][0], 0x40804080U);  // 4.0, 4.0
+
+    // A different expression is a different entry.
+    kernel_b.set_compute_kernel("out0 = in0 + 2.0;");
+    Stream source0(in0, count);
+    Stream sink(out, count);
+    CpuMap map({&kernel_a, &kernel_b}, {&source0, &sink});
+    map.add_connection(&source0, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &kernel_b, "in0");
+    map.add_connection(&kernel_b, "out0", &sink);
+    map.set_kernel_cache(&cache);
+    map.execute();
+    EXPECT_EQ(cache.misses(), 2);
+    EXPECT_EQ(map.read_stream(&sink)[0], 0x40A040A0U);  // 5.0, 5.0
+}
+
+TEST_F(KernelCacheTests, CpuMapStoresProgramBeyondDestRegisters) {
+    uint32_t count = 1024;
+    std::vector<uint32_t> in0(count / 2, 0x3F803F80U);  // 1.0, 1.0
+    std::vector<uint32_t> out(count / 2, 0);
+
+    // Nine values live at once: more than the device's dest registers, fine on the host.
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel(
+        "a0 = in0 + 1.0; a1 = in0 + 2.0; a2 = in0 + 3.0; a3 = in0 + 4.0; a4 = in0 + 5.0; a5 = in0 + 6.0;"
+        "a6 = in0 + 7.0; a7 = in0 + 8.0; a8 = in0 + 9.0;"
+        "out0 = a0 * (a1 * (a2 * (a3 * (a4 * (a5 * (a6 * (a7 * a8)))))));");
+
+    KernelCache cache(dir);
+    std::vector<std::vector<uint32_t>> results;
+    for (int run = 0; run < 2; run++) {
+        Stream source0(in0, count);
+        Stream sink(out, count);
+        CpuMap map({&kernel_a}, {&source0, &sink});
+        map.add_connection(&source0, &kernel_a, "in0");
+        map.add_connection(&kernel_a, "out0", &sink);
+        map.set_kernel_cache(&cache);
+        ASSERT_NO_THROW(map.execute());
+        results.push_back(map.read_stream(&sink));
+    }
+    EXPECT_EQ(cache.misses(), 1);
+    EXPECT_EQ(cache.hits(), 1);
+    EXPECT_EQ(results[0], results[1]);
+}
+
+TEST_F(KernelCacheTests, CpuMapCompilesOnceAcrossPlanAndTraffic) {
+    uint32_t count = 1024;
+    std::vector<uint32_t> in0(count / 2, 0x3F803F80U);  // 1.0, 1.0
+    std::vector<uint32_t> out(count / 2, 0);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 * 3.0;");
+
+    KernelCache cache(dir);
+    Stream source0(in0, count);
+    Stream sink(out, count);
+    CpuMap map({&kernel_a}, {&source0, &sink});
+    map.add_connection(&source0, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &sink);
+    map.set_kernel_cache(&cache);
+    map.plan();
+    map.plan();
+    map.traffic();
+    map.execute();
+    EXPECT_EQ(cache.misses(), 1);
+    EXPECT_EQ(cache.hits(), 0);
+}
@@ -0,0 +1,111 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "host/bf16.hpp"
+#include "host/cpu_map.hpp"
+#include "host/mapped_file.hpp"
+
+using namespace current::host;
+
+namespace {
+
+class MappedFileTests : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        dir = std::filesystem::temp_directory_path() /
+              ("mapped_file_test_" + std::string(::testing::UnitTest::GetInstance()->current_test_info()->name()));
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir);
+    }
+    void TearDown() override { std::filesystem::remove_all(dir); }
+
+    std::filesystem::path dir;
+};
+
+}  // namespace
+
+TEST_F(MappedFileTests, CreateAndReopen) {
+    {
+        auto file = MappedFile::create(dir / "a.bin", DataFormat::Float16_b, 5);
+        EXPECT_EQ(file.num_words(), 3);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(file.words()) % 4096, 0);
+        file.words()[2] = 0x3F80U;
+    }
+    auto file = MappedFile::open(dir / "a.bin");
+    EXPECT_EQ(file.header().count, 5);
+    EXPECT_EQ(file.header().format, DataFormat::Float16_b);
+    EXPECT_FALSE(file.writable());
+    EXPECT_EQ(bf16_to_float(packed_bf16_at(file.words(), 4)), 1.0F);
+
+    std::ofstream(dir / "junk.bin") << std::string(128, 'x');
+    EXPECT_THROW(MappedFile::open(dir / "junk.bin"), std::runtime_error);
+    EXPECT_THROW(MappedFile::open(dir / "missing.bin"), std::runtime_error);
+
+    // Headers whose offset plus size would wrap around must not pass the size check.
+    for (auto [offset, count] : {std::pair<uint64_t, uint64_t>{UINT64_MAX - 3, 4}, {4096, UINT64_MAX}}) {
+        StreamFileHeader header;
+        header.data_offset = offset;
+        header.count = count;
+        std::ofstream crafted(dir / "crafted.bin", std::ios::binary);
+        crafted.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        crafted << std::string(8192, '\0');
+        crafted.close();
+        EXPECT_THROW(MappedFile::open(dir / "crafted.bin"), std::runtime_error) << offset << " " << count;
+    }
+}
+
+TEST_F(MappedFileTests, MappedGatherPipeline) {
+    uint32_t table_n_elements = 2048;
+    uint32_t num_tokens = 1024 * 3 + 1;
+    {
+        auto table = MappedFile::create(dir / "table.bin", DataFormat::Float16_b, table_n_elements);
+        auto indices = MappedFile::create(dir / "indices.bin", DataFormat::UInt32, num_tokens);
+        for (uint32_t i = 0; i < table_n_elements; i++) {
+            table.words()[i / 2] |= static_cast<uint32_t>(float_to_bf16(static_cast<float>(i % 256))) << (16 * (i & 1));
+        }
+        for (uint32_t t = 0; t < num_tokens; t++) {
+            indices.words()[t] = (t * 5) % table_n_elements;
+        }
+        MappedFile::create(dir / "out.bin", DataFormat::Float16_b, num_tokens);
+    }
+
+    auto table = MappedFile::open(dir / "table.bin");
+    auto indices = MappedFile::open(dir / "indices.bin");
+    auto out = MappedFile::open(dir / "out.bin", true);
+
+    Kernel kernel_a;
+    kernel_a.add_input_port("in0");
+    kernel_a.add_output_port("out0");
+    kernel_a.set_compute_kernel("out0 = in0 + 1.0;");
+
+    GatherStream gather_stream(table, indices);
+    Stream sink(out);
+    EXPECT_EQ(gather_stream.size(), num_tokens);
+    CpuMap map({&kernel_a}, {&gather_stream, &sink});
+    map.add_connection(&gather_stream, &kernel_a, "in0");
+    map.add_connection(&kernel_a, "out0", &sink);
+    map.execute();
+
+    // Results land in the mapping itself.
+    for (uint32_t t = 0; t < num_tokens; t++) {
+        ASSERT_EQ(bf16_to_float(packed_bf16_at(out.words(), t)), static_cast<float>((t * 5) % 256 + 1)) << t;
+    }
+
+    Stream read_only_sink(table);
+    CpuMap bad({&kernel_a}, {&gather_stream, &read_only_sink});
+    bad.add_connection(&gather_stream, &kernel_a, "in0");
+    bad.add_connection(&kernel_a, "out0", &read_only_sink);
+    EXPECT_THROW(bad.execute(), std::runtime_error);
+    EXPECT_THROW(Stream{indices}, std::invalid_argument);
+}
@@ -0,0 +1,48 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <vector>
+
+#include "host/microbench.hpp"
+
+using namespace current::host;
+
+TEST(MicroBenchTests, Registry) {
+    auto registry = microbenchmark_registry();
+    ASSERT_FALSE(registry.empty());
+    EXPECT_EQ(registry.front().name, "empty");
+    std::set<std::string> names;
+    for (const auto &benchmark : registry) {
+        EXPECT_TRUE(names.insert(benchmark.name).second) << benchmark.name;
+        auto defines = microbenchmark_defines(benchmark);
+        EXPECT_EQ(defines.at("BENCH_" + benchmark.snippet), "1");
+        // NoC snippets carry their size; only they and CB snippets are limited to the data movement RISCs.
+        EXPECT_EQ(defines.contains("BENCH_BYTES"), benchmark.bytes != 0) << benchmark.name;
+        if (benchmark.bytes != 0) {
+            EXPECT_TRUE(benchmark.data_movement) << benchmark.name;
+        }
+    }
+    EXPECT_TRUE(names.contains("noc_read_2048"));
+    EXPECT_TRUE(names.contains("cb_push_pop"));
+}
+
+TEST(MicroBenchTests, CyclesPerOp) {
+    // Slot words as the kernels write them: BRISC ran past 2^32 cycles.
+    std::vector<uint32_t> words = {5, 1, 3000, 0, 1000, 0, 0, 0, 7, 0};
+    auto cycles = decode_cycles(words);
+    ASSERT_EQ(cycles.size(), MICROBENCH_NUM_RISCS);
+    EXPECT_EQ(cycles[0], (uint64_t{1} << 32) + 5);
+    EXPECT_EQ(cycles[1], 3000);
+    EXPECT_EQ(cycles[4], 7);
+
+    EXPECT_DOUBLE_EQ(cycles_per_op(3000, 1000, 1000), 2.0);
+    EXPECT_DOUBLE_EQ(cycles_per_op(900, 1000, 1000), 0.0);
+    EXPECT_THROW(cycles_per_op(1, 0, 0), std::invalid_argument);
+    EXPECT_THROW(decode_cycles({1, 2, 3}), std::invalid_argument);
+}
@@ -0,0 +1,162 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "host/cpu_map.hpp"
+#include "host/roofline.hpp"
+
+using namespace current::host;
+
+namespace {
+
+// Round numbers: 1 GB/s per bank and per NoC link, 1 cycle per access and per tile op.
+DevicePeaks unit_peaks() {
+    DevicePeaks peaks;
+    peaks.dram_bank_bandwidth = 1e9;
+    peaks.noc_link_bandwidth = 1e9;
+    peaks.clock = 1e9;
+    peaks.cycles_per_access = 1.0;
+    peaks.cycles_per_move_tile = 1.0;
+    peaks.cycles_per_fpu_tile = 1.0;
+    peaks.cycles_per_sfpu_tile = 1.0;
+    return peaks;
+}
+
+CoreLoad core_load(uint32_t x, uint64_t noc_bytes, uint64_t accesses, size_t fpu) {
+    CoreLoad core;
+    core.x = x;
+    core.noc_bytes = noc_bytes;
+    core.accesses = accesses;
+    core.tile_ops.fpu = fpu;
+    return core;
+}
+
+}  // namespace
+
+TEST(RooflineTests, BindingResource) {
+    Traffic traffic;
+    traffic.dram_bank_bytes = {4000, 1000};
+    traffic.cores = {core_load(0, 2000, 100, 100), core_load(1, 3000, 100, 100)};
+
+    // Bank 0 needs 4 us at peak; the busiest NoC link 3 us.
+    auto report = roofline(traffic, 8e-6, unit_peaks());
+    ASSERT_EQ(report.resources.size(), 4);
+    EXPECT_EQ(report.binding.resource, Resource::DramBank);
+    EXPECT_EQ(report.binding.name, "DRAM bank 0");
+    EXPECT_NEAR(report.binding.utilization, 0.5, 1e-9);
+    EXPECT_EQ(report.resources[1].name, "NoC link (1, 0)");
+    EXPECT_NEAR(report.resources[1].seconds, 3e-6, 1e-15);
+    EXPECT_NEAR(report.achieved_dram_bandwidth, 5000 / 8e-6, 1e-3);
+    EXPECT_NEAR(report.peak_dram_bandwidth, 2e9, 1e-3);
+
+    // The same bytes spread over more banks leave the NoC link binding.
+    traffic.dram_bank_bytes = {1250, 1250, 1250, 1250};
+    EXPECT_EQ(roofline(traffic, 8e-6, unit_peaks()).binding.resource, Resource::NocLink);
+
+    // Element-by-element gathering on one core.
+    traffic.cores[0].accesses = 10000;
+    EXPECT_EQ(roofline(traffic, 8e-6, unit_peaks()).binding.name, "reader (0, 0)");
+
+    // SFPU tiles cost more than FPU ones.
+    auto peaks = unit_peaks();
+    peaks.cycles_per_sfpu_tile = 1000.0;
+    traffic.cores[1].tile_ops.sfpu = 20;
+    report = roofline(traffic, 8e-6, peaks);
+    EXPECT_EQ(report.binding.resource, Resource::Compute);
+    EXPECT_EQ(report.binding.name, "compute (1, 0)");
+    EXPECT_NEAR(report.binding.seconds, 20100e-9, 1e-15);
+    EXPECT_GT(report.binding.utilization, 1.0);
+
+    auto text = report.describe();
+    EXPECT_NE(text.find("* compute"), std::string::npos);
+    EXPECT_NE(text.find("bound by compute"), std::string::npos);
+}
+
+TEST(RooflineTests, RejectsBadDurations) {
+    Traffic traffic;
+    EXPECT_THROW(roofline(traffic, 0.0), std::invalid_argument);
+    EXPECT_THROW(roofline(traffic, -1.0), std::invalid_argument);
+
+    // Nothing to do is fine: every resource is unused.
+    auto report = roofline(traffic, 1.0);
+    EXPECT_EQ(report.binding.seconds, 0.0);
+    EXPECT_EQ(report.resources[0].name, "DRAM (unused)");
+}
+
+TEST(RooflineTests, CpuMapStreams) {
+    uint32_t count = 1024 * 4;
+    std::vector<uint32_t> input(count / 2, 0);
+    std::vector<uint32_t> output(count / 2, 0);
+
+    Kernel kernel;
+    kernel.add_input_port("in0");
+    kernel.add_output_port("out0");
+    kernel.set_compute_kernel("out0 = in0 * in0;");
+
+    Stream source(input, count);
+    Stream sink(output, count);
+    CpuMap map({&kernel}, {&source, &sink});
+    map.add_connection(&source, &kernel, "in0");
+    map.add_connection(&kernel, "out0", &sink);
+    map.set_parallelization(2);
+
+    // Four 2048-byte pages in, four out, interleaved from bank 0.
+    auto traffic = map.traffic();
+    ASSERT_EQ(traffic.dram_bank_bytes.size(), 12);
+    for (uint32_t bank = 0; bank < 12; bank++) {
+        EXPECT_EQ(traffic.dram_bank_bytes[bank], bank < 4 ? 4096 : 0) << bank;
+    }
+    EXPECT_EQ(traffic.dram_bytes(), uint64_t{count} * 4);
+    ASSERT_EQ(traffic.cores.size(), 2);
+    for (const auto &core : traffic.cores) {
+        EXPECT_EQ(core.noc_bytes, uint64_t{count} * 2);
+        EXPECT_EQ(core.accesses, 0);
+        EXPECT_EQ(core.tile_ops.fpu, traffic.cores[0].tile_ops.fpu);
+        EXPECT_GT(core.tile_ops.total(), 0);
+    }
+}
+
+TEST(RooflineTests, CpuMapGatherTable) {
+    uint32_t count = 1024;
+    uint32_t table_size = 4096;
+    std::vector<uint32_t> table(table_size / 2, 0);
+    std::vector<uint32_t> indices(count);
+    for (uint32_t i = 0; i < count; i++) {
+        indices[i] = i;
+    }
+    std::vector<uint32_t> output(count / 2, 0);
+
+    Kernel kernel;
+    kernel.add_input_port("in0");
+    kernel.add_output_port("out0");
+    kernel.set_compute_kernel("out0 = in0;");
+
+    GatherStream gather(table, table_size, indices);
+    Stream sink(output, count);
+    CpuMap map({&kernel}, {&gather, &sink});
+    map.add_connection(&gather, &kernel, "in0");
+    map.add_connection(&kernel, "out0", &sink);
+    map.set_parallelization(1);
+
+    uint64_t index_bytes = uint64_t{count} * 4;
+    uint64_t sink_bytes = uint64_t{count} * 2;
+
+    // The 8 KiB table fits L1 and is copied whole.
+    auto resident = map.traffic();
+    ASSERT_EQ(resident.cores.size(), 1);
+    EXPECT_EQ(resident.cores[0].accesses, count);
+    EXPECT_EQ(resident.dram_bytes(), index_bytes + uint64_t{table_size} * 2 + sink_bytes);
+    EXPECT_EQ(resident.cores[0].noc_bytes, resident.dram_bytes());
+
+    // From DRAM, sequential indices fetch each 32-byte chunk once.
+    auto streamed = map.traffic({}, 0);
+    EXPECT_EQ(streamed.cores[0].accesses, count);
+    EXPECT_EQ(streamed.dram_bytes(), index_bytes + uint64_t{count} * 2 + sink_bytes);
+}
@@ -0,0 +1,40 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "host/scan.hpp"
+
+using namespace current::host;
+
+TEST(ScanTests, PrefixSumAcrossBlocks) {
+    // Several scan blocks plus a partial one.
+    std::mt19937 rng(100);
+    std::vector<uint32_t> values((1 << 18) + 123);
+    for (auto &value : values) {
+        value = rng() % 100;
+    }
+    auto inclusive = prefix_sum(values);
+    auto exclusive = prefix_sum(values, ScanKind::Exclusive);
+    ASSERT_EQ(inclusive.size(), values.size());
+    ASSERT_EQ(exclusive.size(), values.size());
+    uint32_t running = 0;
+    for (size_t i = 0; i < values.size(); i++) {
+        ASSERT_EQ(exclusive[i], running) << "i = " << i;
+        running += values[i];
+        ASSERT_EQ(inclusive[i], running) << "i = " << i;
+    }
+    EXPECT_TRUE(prefix_sum({}).empty());
+}
+
+TEST(ScanTests, CsrOffsets) {
+    EXPECT_EQ(csr_offsets({2, 0, 3, 1}), (std::vector<uint32_t>{0, 2, 2, 5, 6}));
+    EXPECT_EQ(csr_offsets({}), (std::vector<uint32_t>{0}));
+    EXPECT_THROW(csr_offsets({UINT32_MAX, 1}), std::overflow_error);
+}
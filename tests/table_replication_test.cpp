@@ -0,0 +1,57 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "host/table_replication.hpp"
+#include "host/work_split.hpp"
+
+using namespace current::host;
+
+TEST(TableReplicationTests, RangesCoverSplit) {
+    // 20 column-major cores: columns 0 and 1 in full, then the first four cores of column 2.
+    auto split = split_work(100, 20);
+    auto ranges = multicast_ranges(split);
+    ASSERT_EQ(ranges.size(), 2);
+    EXPECT_EQ(ranges[0].x0, 0);
+    EXPECT_EQ(ranges[0].x1, 1);
+    EXPECT_EQ(ranges[0].y0, 0);
+    EXPECT_EQ(ranges[0].y1, 7);
+    EXPECT_EQ(ranges[1].x0, 2);
+    EXPECT_EQ(ranges[1].x1, 2);
+    EXPECT_EQ(ranges[1].y1, 3);
+    EXPECT_EQ(ranges[0].size() + ranges[1].size(), 20);
+
+    // A full grid is one range; scattered cores split into runs.
+    EXPECT_EQ(multicast_ranges(split_work(64, 0)).size(), 1);
+    WorkSplit scattered;
+    scattered.cores = {{0, 0, 0, 1}, {0, 1, 1, 1}, {0, 5, 2, 1}, {1, 0, 3, 1}, {1, 1, 4, 1}};
+    auto runs = multicast_ranges(scattered);
+    ASSERT_EQ(runs.size(), 2);
+    EXPECT_EQ(runs[0].size(), 4);
+    EXPECT_EQ(runs[1].size(), 1);
+}
+
+TEST(TableReplicationTests, MulticastStartupIsNearlyConstant) {
+    uint64_t table_bytes = 512 * 1024;
+    auto one = plan_replication(table_bytes, split_work(64, 1));
+    EXPECT_EQ(one.per_core_seconds, one.multicast_seconds);
+    EXPECT_EQ(one.saved_seconds(), 0.0);
+
+    auto eight = plan_replication(table_bytes, split_work(64, 8));
+    auto full = plan_replication(table_bytes, split_work(64, 64));
+    EXPECT_EQ(full.num_cores, 64);
+    EXPECT_NEAR(full.per_core_seconds, 64 * one.per_core_seconds, 1e-9);
+    // Per-core writes scale with the core count; the multicast plan barely moves.
+    EXPECT_NEAR(full.multicast_seconds, eight.multicast_seconds, 1e-9);
+    EXPECT_LT(full.multicast_seconds, 2.5 * one.multicast_seconds);
+    EXPECT_GT(full.saved_seconds(), 60 * one.per_core_seconds);
+    EXPECT_NE(full.describe().find("64 cores"), std::string::npos);
+
+    EXPECT_THROW(plan_replication(table_bytes, WorkSplit{}), std::invalid_argument);
+}
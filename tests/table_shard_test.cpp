@@ -0,0 +1,115 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include "host/bf16.hpp"
+#include "host/table_shard.hpp"
+
+using namespace current::host;
+
+TEST(TableShardTests, LayoutFromTableSize) {
+    // Fits one core: a single shard.
+    auto small = plan_shards(256 * 1024);
+    ASSERT_EQ(small.shards.size(), 1);
+    EXPECT_EQ(small.shards[0].count, 256 * 1024);
+
+    // Just over 24 MiB of bf16 in 1 MiB slices: 25 cores, column-major, every slice 32-byte aligned.
+    uint64_t elements = 12 * 1024 * 1024 + 5;
+    auto layout = plan_shards(elements);
+    ASSERT_EQ(layout.shards.size(), 25);
+    EXPECT_EQ(layout.shard_elements % 16, 0);
+    EXPECT_LE(layout.shard_elements * 2, DEFAULT_SHARD_BUDGET);
+    uint64_t covered = 0;
+    for (size_t i = 0; i < layout.shards.size(); i++) {
+        const auto &shard = layout.shards[i];
+        EXPECT_EQ(shard.first, covered);
+        EXPECT_EQ(shard.x, i / 8);
+        EXPECT_EQ(shard.y, i % 8);
+        EXPECT_GT(shard.count, 0);
+        covered += shard.count;
+    }
+    EXPECT_EQ(covered, elements);
+    EXPECT_EQ(layout.shard_of(layout.shard_elements), 1);
+    EXPECT_EQ(layout.local_of(layout.shard_elements + 3), 3);
+
+    // 64 cores of 1 MiB hold at most 32M bf16 elements.
+    EXPECT_NO_THROW(plan_shards(32 * 1024 * 1024));
+    EXPECT_THROW(plan_shards(32 * 1024 * 1024 + 1), std::invalid_argument);
+    EXPECT_THROW(plan_shards(1024, {}, 16), std::invalid_argument);
+}
+
+TEST(TableShardTests, RoutedGatherMatches) {
+    uint32_t table_n_elements = 100000;
+    uint8_t accesses_per_token = 3;
+    uint32_t num_tokens = 1024 * 4 + 33;
+    std::mt19937 rng(4);
+    std::vector<uint32_t> table((table_n_elements + 1) / 2);
+    for (uint32_t i = 0; i < table_n_elements; i++) {
+        table[i / 2] |= static_cast<uint32_t>(float_to_bf16(static_cast<float>(rng() % 1000))) << (16 * (i & 1));
+    }
+    std::vector<uint32_t> index_vec(num_tokens * accesses_per_token);
+    for (auto &index : index_vec) {
+        index = rng() % table_n_elements;
+    }
+
+    // 16 KiB slices force 13 shards.
+    auto layout = plan_shards(table_n_elements, {}, 16 * 1024);
+    ASSERT_EQ(layout.shards.size(), 13);
+    auto shards = shard_table(table, layout);
+    auto route = route_gather(index_vec, accesses_per_token, layout);
+
+    // One batch per (tile, shard) pair, never more than one per shard per tile.
+    size_t num_tiles = (num_tokens + 1023) / 1024;
+    ASSERT_EQ(route.tile_batches.size(), num_tiles + 1);
+    for (size_t tile = 0; tile < num_tiles; tile++) {
+        EXPECT_LE(route.tile_batches[tile + 1] - route.tile_batches[tile], layout.shards.size());
+    }
+    EXPECT_LT(route.batches.size(), index_vec.size() / 100);
+
+    auto out = gather_routed(shards, route, accesses_per_token);
+    ASSERT_EQ(out.size(), (index_vec.size() + 1) / 2);
+    for (size_t i = 0; i < index_vec.size(); i++) {
+        ASSERT_EQ(packed_bf16_at(out.data(), i), packed_bf16_at(table.data(), index_vec[i])) << "i = " << i;
+    }
+
+    index_vec[7] = table_n_elements;
+    EXPECT_THROW(route_gather(index_vec, accesses_per_token, layout), std::invalid_argument);
+    EXPECT_THROW(route_gather(index_vec, 2, layout), std::invalid_argument);
+}
+
+TEST(TableShardTests, PackedRouteMatches) {
+    uint32_t table_n_elements = 50000;
+    uint32_t num_reads = 1024 * 3;
+    std::mt19937 rng(6);
+    std::vector<uint32_t> index_vec(num_reads);
+    for (auto &index : index_vec) {
+        index = rng() % table_n_elements;
+    }
+    auto layout = plan_shards(table_n_elements, {}, 16 * 1024);
+    auto route = route_gather(index_vec, 1, layout);
+    auto packed = pack_route(route, layout);
+    EXPECT_EQ(packed.counts_stride % 8, 0);
+    EXPECT_GE(packed.counts_stride, layout.shards.size());
+
+    // Walking each tile's counts shard by shard, as the device does, recovers every read.
+    for (size_t tile = 0; tile < num_reads / 1024; tile++) {
+        size_t slot = tile * 1024;
+        for (uint32_t shard = 0; shard < layout.shards.size(); shard++) {
+            for (uint32_t n = 0; n < packed.counts[tile * packed.counts_stride + shard]; n++, slot++) {
+                uint32_t offset = packed.reads[slot] >> PackedRoute::LOCAL_BITS;
+                uint32_t local = packed.reads[slot] & PackedRoute::LOCAL_MASK;
+                ASSERT_EQ(index_vec[tile * 1024 + offset], layout.shards[shard].first + local) << "slot " << slot;
+            }
+        }
+        EXPECT_EQ(slot, (tile + 1) * 1024);
+    }
+
+    EXPECT_THROW(pack_route(route_gather(std::vector<uint32_t>(2048), 2, layout), layout), std::invalid_argument);
+}
@@ -0,0 +1,49 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <cstddef>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "host/thread_pool.hpp"
+
+using namespace current::host;
+
+TEST(ThreadPoolTests, CoversRangeOnce) {
+    ThreadPool pool(4);
+    std::vector<std::atomic<int>> hits(10000);
+    pool.parallel_for(hits.size(), 16, [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            hits[i]++;
+        }
+    });
+    for (size_t i = 0; i < hits.size(); i++) {
+        ASSERT_EQ(hits[i], 1) << "i = " << i;
+    }
+}
+
+TEST(ThreadPoolTests, ThrowingBodyLeavesPoolUsable) {
+    ThreadPool pool(4);
+    // Throw from the range the caller runs first, and from ranges the workers pick up.
+    for (size_t thrower : {size_t{0}, size_t{5000}}) {
+        EXPECT_THROW(
+            pool.parallel_for(
+                10000,
+                1,
+                [&](size_t begin, size_t end) {
+                    if (begin <= thrower && thrower < end) {
+                        throw std::runtime_error("range failed");
+                    }
+                    std::this_thread::yield();
+                }),
+            std::runtime_error);
+    }
+    std::atomic<size_t> total = 0;
+    pool.parallel_for(10000, 1, [&](size_t begin, size_t end) { total += end - begin; });
+    EXPECT_EQ(total, 10000);
+}
@@ -0,0 +1,118 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "host/trace.hpp"
+
+using namespace current::host;
+namespace trace = current::trace;
+
+namespace {
+
+// Appends a record to one RISC's ring the way device/trace.hpp does.
+void append(std::vector<uint32_t> &rings, uint32_t capacity, uint32_t risc, uint32_t tag, uint32_t arg, uint64_t t) {
+    uint32_t *header = rings.data() + risc * trace::trace_ring_bytes(capacity) / sizeof(uint32_t);
+    uint32_t n = header[2];
+    uint32_t *record = header + 4 + (n % capacity) * 4;
+    record[0] = static_cast<uint32_t>(t);
+    record[1] = static_cast<uint32_t>(t >> 32);
+    record[2] = tag;
+    record[3] = arg;
+    header[2] = n + 1;
+}
+
+}  // namespace
+
+TEST(TraceTests, DecodesRings) {
+    constexpr uint32_t capacity = 8;
+    auto rings = empty_trace_rings(capacity);
+    ASSERT_EQ(rings.size() * sizeof(uint32_t), trace::NUM_RISCS * trace::trace_ring_bytes(capacity));
+    append(rings, capacity, trace::BRISC, trace::trace_tag(trace::ZONE_BEGIN, 7), 0, 1000);
+    append(rings, capacity, trace::BRISC, trace::trace_tag(trace::ZONE_END, 7), 0, 1500);
+    append(rings, capacity, trace::NCRISC, trace::trace_tag(trace::NOC_READ, 0), 4096, (uint64_t{1} << 32) + 5);
+    append(rings, capacity, trace::TRISC2, trace::trace_tag(trace::MARK, 3), 42, 1200);
+
+    DecodedTrace decoded;
+    decode_trace(rings, capacity, 2, 3, decoded);
+    ASSERT_EQ(decoded.events.size(), 4);
+    EXPECT_EQ(decoded.dropped, 0);
+    EXPECT_EQ(decoded.events[0].kind, trace::ZONE_BEGIN);
+    EXPECT_EQ(decoded.events[0].id, 7);
+    EXPECT_EQ(decoded.events[0].core_x, 2);
+    EXPECT_EQ(decoded.events[0].core_y, 3);
+    EXPECT_EQ(decoded.events[1].cycles, 1500);
+    EXPECT_EQ(decoded.events[2].risc, trace::NCRISC);
+    EXPECT_EQ(decoded.events[2].arg, 4096);
+    EXPECT_EQ(decoded.events[2].cycles, (uint64_t{1} << 32) + 5);
+    EXPECT_EQ(decoded.events[3].risc, trace::TRISC2);
+    EXPECT_EQ(decoded.events[3].arg, 42);
+}
+
+TEST(TraceTests, WrappedRingKeepsNewest) {
+    constexpr uint32_t capacity = 4;
+    auto rings = empty_trace_rings(capacity);
+    for (uint32_t i = 0; i < 10; i++) {
+        append(rings, capacity, trace::BRISC, trace::trace_tag(trace::MARK, i), i, 100 + i);
+    }
+    DecodedTrace decoded;
+    decode_trace(rings, capacity, 0, 0, decoded);
+    ASSERT_EQ(decoded.events.size(), capacity);
+    EXPECT_EQ(decoded.dropped, 6);
+    for (uint32_t i = 0; i < capacity; i++) {
+        EXPECT_EQ(decoded.events[i].id, 6 + i);
+        EXPECT_EQ(decoded.events[i].cycles, 106 + i);
+    }
+}
+
+TEST(TraceTests, RejectsBadRings) {
+    auto rings = empty_trace_rings(4);
+    DecodedTrace decoded;
+    EXPECT_THROW(decode_trace(rings, 8, 0, 0, decoded), std::invalid_argument);
+    rings[0] = 0;
+    EXPECT_THROW(decode_trace(rings, 4, 0, 0, decoded), std::invalid_argument);
+    rings = empty_trace_rings(4);
+    append(rings, 4, trace::BRISC, 0xFF000000, 0, 0);
+    EXPECT_THROW(decode_trace(rings, 4, 0, 0, decoded), std::invalid_argument);
+}
+
+TEST(TraceTests, Exports) {
+    constexpr uint32_t capacity = 4;
+    auto rings = empty_trace_rings(capacity);
+    append(rings, capacity, trace::BRISC, trace::trace_tag(trace::ZONE_BEGIN, 1), 0, 2000);
+    append(rings, capacity, trace::BRISC, trace::trace_tag(trace::NOC_WRITE, 0), 2048, 2500);
+    append(rings, capacity, trace::BRISC, trace::trace_tag(trace::ZONE_END, 1), 0, 3000);
+    DecodedTrace decoded;
+    decode_trace(rings, capacity, 1, 0, decoded);
+    TraceNames names = {{1, "gather \"tile\""}};
+
+    std::ostringstream csv;
+    write_trace_csv(csv, decoded, names);
+    EXPECT_EQ(
+        csv.str(),
+        "core_x,core_y,risc,kind,id,name,arg,cycles\n"
+        "1,0,BRISC,zone_begin,1,gather \"tile\",0,2000\n"
+        "1,0,BRISC,noc_write,0,noc_write,2048,2500\n"
+        "1,0,BRISC,zone_end,1,gather \"tile\",0,3000\n");
+
+    std::ostringstream json;
+    write_chrome_trace(json, decoded, names, 1000.0);
+    std::string text = json.str();
+    EXPECT_NE(text.find("\"name\":\"core (1, 0)\""), std::string::npos);
+    EXPECT_NE(text.find("\"name\":\"BRISC\""), std::string::npos);
+    EXPECT_NE(text.find("{\"ph\":\"B\",\"name\":\"gather \\\"tile\\\"\",\"pid\":1,\"tid\":0,\"ts\":0.000}"),
+              std::string::npos);
+    EXPECT_NE(text.find("\"ph\":\"i\",\"name\":\"noc_write\",\"pid\":1,\"tid\":0,\"ts\":0.500,\"s\":\"t\","
+                        "\"args\":{\"bytes\":2048}"),
+              std::string::npos);
+    EXPECT_NE(text.find("\"ph\":\"E\""), std::string::npos);
+    EXPECT_EQ(text.front(), '{');
+    EXPECT_EQ(text.substr(text.size() - 3), "]}\n");
+}
@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: (c) 2024 Tenstorrent AI ULC
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <set>
+#include <stdexcept>
+#include <utility>
+
+#include "host/work_split.hpp"
+
+using namespace current::host;
+
+namespace {
+
+// Every tile covered exactly once, in order, by distinct in-grid cores with nonzero work.
+void expect_valid(const WorkSplit &split, CoreGrid grid) {
+    uint32_t next = 0;
+    std::set<std::pair<uint32_t, uint32_t>> used;
+    for (const auto &core : split.cores) {
+        EXPECT_EQ(core.first_tile, next);
+        EXPECT_GT(core.num_tiles, 0);
+        EXPECT_LT(core.x, grid.x);
+        EXPECT_LT(core.y, grid.y);
+        EXPECT_TRUE(used.insert({core.x, core.y}).second);
+        next += core.num_tiles;
+    }
+    EXPECT_EQ(next, split.num_tiles);
+}
+
+}  // namespace
+
+TEST(WorkSplitTests, AnyCoreCount) {
+    CoreGrid grid;
+    for (uint32_t cores = 1; cores <= grid.size(); cores++) {
+        for (uint32_t tiles : {1U, 2U, 7U, 63U, 64U, 1000U, 65537U}) {
+            auto split = split_work(tiles, cores, grid);
+            expect_valid(split, grid);
+            EXPECT_EQ(split.cores.size(), std::min(cores, tiles));
+            // Balanced to within one tile.
+            uint32_t min = UINT32_MAX;
+            for (const auto &core : split.cores) {
+                min = std::min(min, core.num_tiles);
+            }
+            EXPECT_LE(split.max_tiles_per_core() - min, 1);
+        }
+    }
+}
+
+TEST(WorkSplitTests, FullGrid) {
+    CoreGrid grid{12, 9};
+    auto split = split_work(1000, 0, grid);
+    expect_valid(split, grid);
+    EXPECT_EQ(split.cores.size(), 108);
+    EXPECT_EQ(split.max_tiles_per_core(), 10);
+    // Column-major: the second core is below the first.
+    EXPECT_EQ(split.cores[1].x, 0);
+    EXPECT_EQ(split.cores[1].y, 1);
+    EXPECT_EQ(split.cores[9].x, 1);
+}
+
+TEST(WorkSplitTests, Granularity) {
+    CoreGrid grid;
+    // 7 cores, units of 3 tiles: 100 tiles are 34 units (the last one a single tile), dealt 5,5,5,5,5,5,4.
+    auto split = split_work(100, 7, grid, 3);
+    expect_valid(split, grid);
+    ASSERT_EQ(split.cores.size(), 7);
+    for (size_t i = 0; i + 1 < split.cores.size(); i++) {
+        EXPECT_EQ(split.cores[i].num_tiles % 3, 0);
+    }
+    EXPECT_EQ(split.cores.front().num_tiles, 15);
+    EXPECT_EQ(split.cores.back().num_tiles, 10);
+
+    EXPECT_TRUE(split_work(0, 4).cores.empty());
+    EXPECT_THROW(split_work(10, 4, grid, 0), std::invalid_argument);
+}